@@ -4,12 +4,38 @@
 #include "managing_structs.h"
 #include "BmpImage.h"
 #include "BmpConverter.h"
+#include "ImageView.h"
+#include "PixelBuffer.h"
+#include "NoiseGenerator.h"
+#include "Convolution.h"
+#include "MedianFilter.h"
+#include "Resampler.h"
+#include "Reorientation.h"
+#include "ImageStatistics.h"
+#include "ColorSpace.h"
+#include "Thresholding.h"
+#include "Compositing.h"
+#include "PlanarImage.h"
+#include "ConnectedComponents.h"
+#include "DirtyRows.h"
 #include "ImageType.h"
 #include "Point.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <unordered_map>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace bmp {
 
@@ -20,7 +46,15 @@ namespace bmp {
         BmpColorHeader color_header;
         Palette palette;
 
-        std::vector<uint8_t> data;
+        // While a planar copy is resident it holds the pixels and data is stale. Non-const access to
+        // data writes the planes back first; const members never do, and those that need the
+        // interleaved bytes throw while the image is planar, so const calls leave the handler as is.
+        PixelBuffer data;
+        std::optional<PlanarImage> planar;
+
+        // The file data matches except for the dirty rows; empty for an image never read or written
+        std::string backing_file;
+        DirtyRows dirty;
 
         BmpImage* bmp_image;
 
@@ -75,6 +109,33 @@ namespace bmp {
             }
         }
 
+        static uint16_t bit_count_of(const ImageType type) {
+            switch (type) {
+                case INDEXED_1BIT:
+                    return 1;
+                case INDEXED_2BIT:
+                    return 2;
+                case INDEXED_4BIT:
+                    return 4;
+                case INDEXED_8BIT:
+                    return 8;
+                case RGB:
+                    return 24;
+                case RGBA:
+                    return 32;
+                default:
+                    throw std::runtime_error("Unrecognized type of image");
+            }
+        }
+
+        static uint32_t white_of(const ImageType type) {
+            const uint16_t bit_count = bit_count_of(type);
+            if (bit_count == 32) {
+                return 0xFFFFFFFF;
+            }
+            return bit_count == 24 ? 0xFFFFFF : (1u << bit_count) - 1;
+        }
+
         void read(const std::string& filename) {
 
             std::ifstream file{filename, std::ios::binary};
@@ -88,6 +149,9 @@ namespace bmp {
             file.seekg(file_header.offset, std::ifstream::beg);
 
             bmp_image->read_data(file);
+
+            backing_file = filename;
+            dirty.reset(std::abs(info_header.height));
         }
 
         void read_headers(std::ifstream& file) {
@@ -95,6 +159,183 @@ namespace bmp {
             file.read(reinterpret_cast<char *>(&info_header), sizeof(info_header));
         }
 
+        // Keeps the sign of height, i.e. whether the file is stored bottom-up or top-down
+        void set_dimensions(const int32_t width, const int32_t height) {
+            info_header.width = width;
+            info_header.height = info_header.height < 0 ? -height : height;
+            info_header.size_image = get_row_stride() * height;
+            file_header.file_size = file_header.offset + info_header.size_image;
+            dirty.mark_all();
+        }
+
+        void synchronize() {
+            if (!planar) {
+                return;
+            }
+            data.resize(static_cast<size_t>(get_row_stride()) * std::abs(info_header.height));
+            planar->to_interleaved({data.data(), info_header.width, std::abs(info_header.height), get_row_stride(), info_header.bit_count});
+            planar.reset();
+            dirty.mark_all();
+        }
+
+        void require_interleaved() const {
+            if (planar) {
+                throw std::logic_error("BmpHandler: the image is planar, call to_interleaved() first");
+            }
+        }
+
+        // Runs a source-to-target operation on every plane into a new planar image of the given size
+        template<typename PlaneOperation>
+        void apply_to_planes(const int32_t width, const int32_t height, PlaneOperation&& operation) {
+            PlanarImage result(width, height, planar->channel_count());
+            for (int channel = 0; channel < planar->channel_count(); ++channel) {
+                operation(std::as_const(*planar).plane(channel), result.plane(channel));
+            }
+            planar = std::move(result);
+        }
+
+        template<typename Transposition>
+        void apply_transposition(Transposition&& transposition) {
+            const int32_t width = std::abs(info_header.height);
+            const int32_t height = info_header.width;
+            if (planar) {
+                apply_to_planes(width, height, transposition);
+                set_dimensions(width, height);
+                return;
+            }
+
+            const int32_t stride = static_cast<int32_t>(((width * info_header.bit_count + 31) / 32) * 4);
+            PixelBuffer result(static_cast<size_t>(stride) * height);
+
+            transposition(std::as_const(*this).view(), {result.data(), width, height, stride, info_header.bit_count});
+
+            data.swap(result);
+            set_dimensions(width, height);
+        }
+
+        // Maps every color byte through the table; alpha of 32-bit images is left as is
+        void apply_lookup_table(const std::array<uint8_t, 256>& table) {
+            if (planar) {
+                for (int channel = 0; channel < std::min(planar->channel_count(), 3); ++channel) {
+                    const ImageView plane = planar->plane(channel);
+                    parallel::for_each_range(0, plane.height, [&](const int64_t first, const int64_t last) {
+                        for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                            uint8_t* row = plane.row(y);
+                            for (int32_t x = 0; x < plane.width; ++x) {
+                                row[x] = table[row[x]];
+                            }
+                        }
+                    }, 64);
+                }
+                return;
+            }
+
+            const ImageView pixels = view();
+            const int bytes_per_pixel = pixels.bytes_per_pixel();
+            const size_t row_bytes = pixels.row_size_in_bytes();
+
+            parallel::for_each_range(0, pixels.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    uint8_t* row = pixels.row(y);
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        if (bytes_per_pixel != 4 || i % 4 != 3) {
+                            row[i] = table[row[i]];
+                        }
+                    }
+                }
+            }, 64);
+        }
+
+        template<typename Filter>
+        void apply_filter(Filter&& filter) {
+            if (planar) {
+                apply_to_planes(planar->get_width(), planar->get_height(), filter);
+                return;
+            }
+
+            PixelBuffer result(data.size());
+            ImageView destination = view();
+            destination.data = result.data();
+
+            filter(std::as_const(*this).view(), destination);
+
+            data.swap(result);
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        static bool write_fully(const int fd, const uint8_t* bytes, size_t size, off_t offset) {
+            while (size > 0) {
+                const ssize_t written = ::pwrite(fd, bytes, size, offset);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                bytes += written;
+                size -= static_cast<size_t>(written);
+                offset += written;
+            }
+            return true;
+        }
+#endif
+
+        // Overwrites just the dirty rows of backing_file, at the offsets write_data would put them.
+        // Returns false, having written nothing, when the file no longer starts with this image's
+        // headers or is too short; false after a failed write leaves the file for a full rewrite.
+        bool write_dirty_rows() const {
+#if defined(__unix__) || defined(__APPLE__)
+            const int fd = ::open(backing_file.c_str(), O_RDWR);
+            if (fd < 0) {
+                return false;
+            }
+
+            const int32_t stride = get_row_stride();
+            const int32_t height = std::abs(info_header.height);
+            BmpHeader stored_file_header {};
+            BmpInfoHeader stored_info_header {};
+            struct stat status {};
+            bool written =
+                ::pread(fd, &stored_file_header, sizeof(stored_file_header), 0) == sizeof(stored_file_header) &&
+                ::pread(fd, &stored_info_header, sizeof(stored_info_header), sizeof(stored_file_header)) == sizeof(stored_info_header) &&
+                std::memcmp(&stored_file_header, &file_header, sizeof(file_header)) == 0 &&
+                std::memcmp(&stored_info_header, &info_header, sizeof(info_header)) == 0 &&
+                ::fstat(fd, &status) == 0 &&
+                static_cast<uint64_t>(status.st_size) >= file_header.offset + static_cast<uint64_t>(stride) * height;
+
+            // A bottom-up file holds a run of rows in reverse order; it is staged a megabyte at a time
+            const int32_t rows_per_chunk = std::max<int32_t>(1, (1 << 20) / std::max(stride, 1));
+            std::vector<uint8_t> staging;
+            dirty.for_each_run([&](const int32_t first, const int32_t last) {
+                if (!written) {
+                    return;
+                }
+                if (info_header.height < 0) {
+                    written = write_fully(fd, data.data() + static_cast<size_t>(first) * stride,
+                                          static_cast<size_t>(last - first) * stride,
+                                          file_header.offset + static_cast<off_t>(first) * stride);
+                    return;
+                }
+                for (int32_t chunk_last = last; written && chunk_last > first;) {
+                    const int32_t chunk_first = std::max(first, chunk_last - rows_per_chunk);
+                    staging.resize(static_cast<size_t>(chunk_last - chunk_first) * stride);
+                    for (int32_t y = chunk_first; y < chunk_last; ++y) {
+                        std::memcpy(staging.data() + static_cast<size_t>(chunk_last - 1 - y) * stride,
+                                    data.data() + static_cast<size_t>(y) * stride, stride);
+                    }
+                    written = write_fully(fd, staging.data(), staging.size(),
+                                          file_header.offset + static_cast<off_t>(height - chunk_last) * stride);
+                    chunk_last = chunk_first;
+                }
+            });
+
+            ::close(fd);
+            return written;
+#else
+            return false;
+#endif
+        }
+
     public:
 
         explicit BmpHandler(const std::string& filename) : bmp_image(nullptr), bmp_converter(nullptr) {
@@ -102,11 +343,26 @@ namespace bmp {
             read(filename);
         }
 
-        explicit BmpHandler(const ImageType type) : bmp_converter(nullptr) {
-            bmp_image = define_image_type(type);
-            bmp_image->create_blank();
+        // A width x height image with every pixel set to background: a palette index for indexed
+        // types (their palette is a gray ramp, so 0 is black and the last index white), otherwise
+        // blue | green << 8 | red << 16, with the alpha of RGBA pixels in the top byte. A zero
+        // background leaves the pixel buffer's zero pages untouched, so a blank canvas takes no
+        // memory until it is drawn on.
+        BmpHandler(const int32_t width, const int32_t height, const ImageType type, const uint32_t background = 0) :
+            bmp_image(nullptr), bmp_converter(nullptr) {
+            // Owned here until nothing can throw any more, since the destructor does not run for a
+            // constructor that throws
+            std::unique_ptr<BmpImage> image {define_image_type(type)};
+            image->create_blank(width, height, bit_count_of(type));
+            if (background != 0) {
+                BackgroundFill::fill(view(), background);
+            }
+            bmp_image = image.release();
         }
 
+        // The default 1080 x 720 white canvas
+        explicit BmpHandler(const ImageType type) : BmpHandler(1080, 720, type, white_of(type)) {}
+
         ~BmpHandler() {
             delete bmp_image;
         }
@@ -114,7 +370,16 @@ namespace bmp {
         BmpHandler(const BmpHandler&) = delete;
         BmpHandler& operator=(const BmpHandler&) = delete;
 
-        void write(const std::string& filename) const {
+        // Saving back to the file the image was read from or last written to rewrites only the rows
+        // drawn on since, provided nothing else has changed the pixels or the layout
+        void write(const std::string& filename) {
+            synchronize();
+
+            if (filename == backing_file && !dirty.all() && write_dirty_rows()) {
+                dirty.reset(std::abs(info_header.height));
+                return;
+            }
+
             std::ofstream file {filename, std::ios::binary};
 
             if (!file) {
@@ -126,18 +391,19 @@ namespace bmp {
             file.seekp(file_header.offset, std::ofstream::beg);
 
             bmp_image->write_data(file);
+
+            backing_file = filename;
+            dirty.reset(std::abs(info_header.height));
         }
 
         void change_pattern(const std::vector<uint8_t>& bytes, const int index) {
+            synchronize();
+            dirty.mark(index / get_row_stride(), static_cast<int32_t>((index + bytes.size() + get_row_stride() - 1) / get_row_stride()));
             for (int i = index; i < index + bytes.size() && i < data.size(); ++i) {
                 data[i] = bytes[i - index];
             }
         }
 
-        void draw_pixel_black(const uint32_t index) const {
-            return bmp_image->draw_pixel_black(index);
-        }
-
         [[nodiscard]] uint64_t get_number_of_pixels() const {
             return info_header.width * info_header.height;
         }
@@ -154,7 +420,36 @@ namespace bmp {
             return info_header.height;
         }
 
+        [[nodiscard]] int32_t get_row_stride() const {
+            return static_cast<int32_t>(((info_header.width * info_header.bit_count + 31) / 32) * 4);
+        }
+
+        // Anything may be written through this view, so the whole image counts as changed
+        [[nodiscard]] ImageView view() {
+            synchronize();
+            dirty.mark_all();
+            return {data.data(), info_header.width, std::abs(info_header.height), get_row_stride(), info_header.bit_count};
+        }
+
+        // For a caller that reports every row it writes through mark_dirty, keeping saves incremental
+        [[nodiscard]] ImageView tracked_view() {
+            synchronize();
+            return {data.data(), info_header.width, std::abs(info_header.height), get_row_stride(), info_header.bit_count};
+        }
+
+        // Rows [first_row, last_row) were written through tracked_view; safe to call from threads
+        // marking disjoint rows
+        void mark_dirty(const int32_t first_row, const int32_t last_row) {
+            dirty.mark(first_row, last_row);
+        }
+
+        [[nodiscard]] ConstImageView view() const {
+            require_interleaved();
+            return {data.data(), info_header.width, std::abs(info_header.height), get_row_stride(), info_header.bit_count};
+        }
+
         [[nodiscard]] uint8_t get_byte_value(const uint index) const {
+            require_interleaved();
             return data[index];
         }
 
@@ -162,6 +457,7 @@ namespace bmp {
             if (info_header.bit_count < 8) {
                 throw std::runtime_error("Not enough bits for color value");
             }
+            require_interleaved();
             const uint number_of_bytes = info_header.bit_count / 8;
             const uint index = point.x * number_of_bytes * info_header.width + point.y * number_of_bytes;
 
@@ -172,20 +468,152 @@ namespace bmp {
             return color_values;
         }
 
-        void make_noise(const int percent_of_picture_to_change) {
-            const float part_of_picture_to_change = static_cast<float>(percent_of_picture_to_change) / 100.0f;
-            const int size = static_cast<int>(part_of_picture_to_change * static_cast<float>(get_image_size_in_bytes()));
-            std::vector<uint8_t> bytes;
-            bytes.resize(size);
+        // Keeps one plane per channel until the pixels are read back as interleaved bytes: filters,
+        // resizing, reorientation, lookup-table adjustments and statistics then run on 8-bit planes.
+        // Pays off for pipelines of several such operations on 24 and 32-bit images.
+        void to_planar() {
+            if (planar) {
+                return;
+            }
+            planar = PlanarImage::from_interleaved(view());
+            PixelBuffer().swap(data);
+        }
+
+        void to_interleaved() {
+            synchronize();
+        }
+
+        [[nodiscard]] bool is_planar() const {
+            return planar.has_value();
+        }
+
+        void make_noise(const int percent_of_picture_to_change, const uint64_t seed = 0) {
+            NoiseParameters parameters;
+            parameters.model = NoiseModel::SALT_AND_PEPPER;
+            parameters.density = std::clamp(percent_of_picture_to_change, 0, 100) / 100.0;
+            parameters.seed = seed;
 
-            for (int i = 0; i < size; ++i) {
-                bytes[i] = rand() % 255;
+            make_noise(parameters);
+        }
+
+        void make_noise(const NoiseParameters& parameters) {
+            const NoiseGenerator generator(parameters);
+            generator.apply(view());
+        }
+
+        // Filters read the current pixels and write into a fresh buffer that then replaces them.
+        // 8-bit images are filtered by palette index, which assumes a grayscale palette.
+        void convolve(const Kernel& kernel, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                ConvolutionFilter::convolve(src, dst, kernel, border);
+            });
+        }
+
+        void convolve(const SeparableKernel& kernel, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                ConvolutionFilter::convolve(src, dst, kernel, border);
+            });
+        }
+
+        void box_blur(const int32_t radius, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                ConvolutionFilter::box_blur(src, dst, radius, border);
+            });
+        }
+
+        void gaussian_blur(const double sigma, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                ConvolutionFilter::gaussian_blur(src, dst, sigma, border);
+            });
+        }
+
+        void sharpen(const double sigma = 1.0, const double amount = 1.0, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                ConvolutionFilter::unsharp_mask(src, dst, sigma, amount, border);
+            });
+        }
+
+        void median_filter(const int32_t radius = 1, const BorderMode border = BorderMode::CLAMP) {
+            apply_filter([&](const ConstImageView& src, const ImageView& dst) {
+                MedianFilter::apply(src, dst, radius, border);
+            });
+        }
+
+        void resize(const int32_t width, const int32_t height, const ResampleFilter filter = ResampleFilter::BILINEAR) {
+            if (width <= 0 || height <= 0) {
+                throw std::invalid_argument("Image dimensions must be positive");
+            }
+            if (planar) {
+                apply_to_planes(width, height, [&](const ConstImageView& src, const ImageView& dst) {
+                    Resampler::resize(src, dst, filter);
+                });
+                set_dimensions(width, height);
+                return;
+            }
+
+            const int32_t stride = static_cast<int32_t>(((width * info_header.bit_count + 31) / 32) * 4);
+            PixelBuffer result(static_cast<size_t>(stride) * height);
+
+            Resampler::resize(std::as_const(*this).view(), {result.data(), width, height, stride, info_header.bit_count}, filter);
+
+            data.swap(result);
+            set_dimensions(width, height);
+        }
+
+        void flip_vertical() {
+            if (planar) {
+                for (int channel = 0; channel < planar->channel_count(); ++channel) {
+                    Reorientation::flip_vertical(planar->plane(channel));
+                }
+                return;
+            }
+            Reorientation::flip_vertical(view());
+        }
+
+        void flip_horizontal() {
+            if (planar) {
+                for (int channel = 0; channel < planar->channel_count(); ++channel) {
+                    Reorientation::flip_horizontal(planar->plane(channel));
+                }
+                return;
             }
+            Reorientation::flip_horizontal(view());
+        }
+
+        void rotate_180() {
+            flip_vertical();
+            flip_horizontal();
+        }
 
-            change_pattern(bytes, 0);
+        void transpose() {
+            apply_transposition(Reorientation::transpose);
+        }
+
+        void rotate_90_clockwise() {
+            apply_transposition(Reorientation::rotate_90_clockwise);
+        }
+
+        void rotate_90_counterclockwise() {
+            apply_transposition(Reorientation::rotate_90_counterclockwise);
+        }
+
+        // Draws overlay onto this image with its top-left pixel at column left, row top (counted from
+        // the top). Another overlay must be interleaved, see to_interleaved().
+        void composite(const BmpHandler& overlay, const int32_t left = 0, const int32_t top = 0,
+                       const BlendMode mode = BlendMode::OVER, const uint8_t opacity = 255) {
+            if (&overlay == this) {
+                const ImageView destination = view();
+                const PixelBuffer copy = data;
+                ConstImageView source = destination;
+                source.data = copy.data();
+                Compositor::composite(source, destination, left, top, mode, opacity);
+                return;
+            }
+            Compositor::composite(overlay.view(), view(), left, top, mode, opacity);
         }
 
         void to_8bit(Palette palette) {
+            synchronize();
             if (const auto rgb_image{dynamic_cast<RgbBmpImage*>(bmp_image)}; !rgb_image) {
                 throw std::runtime_error("Could not create RGB image");
             }
@@ -200,60 +628,185 @@ namespace bmp {
             );
 
             bmp_converter->convert();
+            dirty.mark_all();
 
             delete bmp_converter;
             bmp_converter = nullptr;
         }
 
         void to_monochrome(const int p = 127) {
-            const auto indexed_image{dynamic_cast<IndexedBmpImage*>(bmp_image)};
+            synchronize();
+            if (dynamic_cast<RgbBmpImage*>(bmp_image)) {
+                bmp_converter = new BmpConverterRgbToMonochrome(
+                    bmp_image,
+                    file_header,
+                    info_header,
+                    data,
+                    palette,
+                    p
+                );
+            } else if (dynamic_cast<IndexedBmpImage*>(bmp_image)) {
+                bmp_converter = new BmpConverterIndexed8BitToMonochrome(
+                    bmp_image,
+                    file_header,
+                    info_header,
+                    data,
+                    this->palette,
+                    p
+                );
+            } else {
+                throw std::runtime_error("Could not convert image to monochrome");
+            }
 
-            if (!indexed_image) {
+            bmp_converter->convert();
+            dirty.mark_all();
+
+            delete bmp_converter;
+            bmp_converter = nullptr;
+        }
+
+        void to_monochrome(const ThresholdMethod method) {
+            synchronize();
+            to_monochrome(select_threshold(method));
+        }
+
+        // RGB images go through to_8bit first: the window sums need the gray values in memory
+        void to_monochrome(const AdaptiveThresholdParameters& parameters) {
+            synchronize();
+            if (dynamic_cast<RgbBmpImage*>(bmp_image)) {
                 Palette palette;
                 palette.make_grayscale();
                 to_8bit(palette);
             }
 
-            bmp_converter = new BmpConverterIndexed8BitToMonochrome(
+            if (info_header.bit_count != 8) {
+                throw std::runtime_error("Adaptive thresholding requires an 8-bit or RGB image");
+            }
+
+            bmp_converter = new BmpConverterIndexed8BitToMonochromeAdaptive(
                 bmp_image,
                 file_header,
                 info_header,
                 data,
                 this->palette,
-                p
+                parameters
             );
 
             bmp_converter->convert();
+            dirty.mark_all();
 
             delete bmp_converter;
             bmp_converter = nullptr;
         }
 
+        template<typename Sum = uint64_t>
+        [[nodiscard]] IntegralImage<Sum> integral_image(const bool with_squares = false) const {
+            return IntegralImage<Sum>(view(), with_squares);
+        }
+
+        // One counting pass over the pixels, then O(256) work on the histogram
+        [[nodiscard]] int select_threshold(const ThresholdMethod method) const {
+            return ThresholdSelector::select(ThresholdSelector::gray_histogram(view()), method);
+        }
+
+        [[nodiscard]] ComponentLabels connected_components(const Connectivity connectivity = Connectivity::FOUR) const {
+            return ConnectedComponents::label(view(), connectivity);
+        }
+
+        // value is a palette index, or blue | green << 8 | red << 16 for 24 and 32-bit images
+        void fill_component(const ComponentLabels& labels, const uint32_t label, const uint32_t value) {
+            ConnectedComponents::fill(view(), labels, label, value);
+        }
+
+        [[nodiscard]] ImageStatistics statistics() const {
+            if (planar) {
+                ImageStatistics image_statistics;
+                for (int channel = 0; channel < planar->channel_count(); ++channel) {
+                    image_statistics.channels.push_back(ImageStatistics::compute(std::as_const(*planar).plane(channel)).channels[0]);
+                }
+                return image_statistics;
+            }
+            return ImageStatistics::compute(view());
+        }
+
+        // Stretches the range between the clip_percent and 100 - clip_percent percentiles to 0..255.
+        // The bounds are shared by all color channels so hues are preserved.
+        void auto_contrast(const double clip_percent = 0.5) {
+            if (info_header.bit_count < 8) {
+                throw std::runtime_error("Auto contrast requires at least 8 bits per pixel");
+            }
+
+            const ImageStatistics image_statistics = statistics();
+            const size_t color_channels = std::min<size_t>(image_statistics.channels.size(), 3);
+
+            int low = 255;
+            int high = 0;
+            for (size_t channel = 0; channel < color_channels; ++channel) {
+                low = std::min<int>(low, image_statistics.channels[channel].percentile(clip_percent));
+                high = std::max<int>(high, image_statistics.channels[channel].percentile(100.0 - clip_percent));
+            }
+
+            if (high <= low) {
+                return;
+            }
+
+            std::array<uint8_t, 256> table {};
+            for (int value = 0; value < 256; ++value) {
+                table[value] = static_cast<uint8_t>(std::clamp((value - low) * 255 / (high - low), 0, 255));
+            }
+            apply_lookup_table(table);
+        }
+
+        void change_luma(const int delta) {
+            ColorSpace::adjust_luma(view(), delta);
+        }
+
+        void scale_saturation(const double factor) {
+            ColorSpace::scale_saturation(view(), static_cast<float>(factor));
+        }
+
+        void change_lightness(const double delta) {
+            ColorSpace::adjust_lightness(view(), static_cast<float>(delta));
+        }
+
         [[nodiscard]] std::unordered_map<uint8_t, int> get_color_histogram() const {
+            require_interleaved();
             return bmp_image->get_color_histogram();
         }
 
-        void change_brightness(const int brightness) const {
+        void change_brightness(const int brightness) {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->change_brightness(brightness);
         }
 
-        void negative_transform() const {
+        void negative_transform() {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->transform_to_negative();
         }
 
-        void negative_transform(const int p) const {
+        void negative_transform(const int p) {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->transform_to_negative(p);
         }
 
-        void increase_contrast(const uint8_t q1, const uint8_t q2) const {
+        void increase_contrast(const uint8_t q1, const uint8_t q2) {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->increase_contrast(q1, q2);
         }
 
-        void decrease_contrast(const uint8_t q1, const uint8_t q2) const {
+        void decrease_contrast(const uint8_t q1, const uint8_t q2) {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->decrease_contrast(q1, q2);
         }
 
-        void gamma_correct(const int gamma) const {
+        void gamma_correct(const int gamma) {
+            synchronize();
+            dirty.mark_all();
             return bmp_image->gamma_correct(gamma);
         }
     };
@@ -3,8 +3,18 @@
 
 #include "BmpImage.h"
 #include "managing_structs.h"
+#include "IntegralImage.h"
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
 
 namespace bmp {
+    // Gray level of an RGB pixel, truncated. Evaluated in double exactly as the converters always
+    // have: some sums that are whole in exact arithmetic land just below, so integer weights differ.
+    inline uint8_t luminance(const uint8_t b, const uint8_t g, const uint8_t r) {
+        return static_cast<uint8_t>(0.3 * r + 0.59 * g + 0.11 * b);
+    }
+
     class BmpConverter {
     protected:
         BmpImage*& bmp_image;
@@ -22,7 +32,7 @@ namespace bmp {
     class BmpConverterRgbToIndexed8Bit final : public BmpConverter {
         BmpHeader& file_header;
         BmpInfoHeader& info_header;
-        std::vector<uint8_t>& data;
+        PixelBuffer& data;
         Palette& palette;
 
         uint32_t calculate_offset() const override {
@@ -38,6 +48,7 @@ namespace bmp {
 
             info_header.bit_count = 8;
             file_header.offset = calculate_offset();
+            file_header.file_size = file_header.offset + info_header.size_image;
         }
     public:
 
@@ -45,7 +56,7 @@ namespace bmp {
             BmpImage*& image,
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& data,
+            PixelBuffer& data,
             Palette& palette) : BmpConverter(image),
         file_header(file_header), info_header(info_header), data(data), palette(palette) {}
 
@@ -57,16 +68,20 @@ namespace bmp {
             delete bmp_image;
             bmp_image = new IndexedBmpImage(file_header, info_header, data , palette);
 
-            std::vector<uint8_t> new_data;
+            const int width = info_header.width;
+            const int height = std::abs(info_header.height);
+            const int src_stride = (width * 3 + 3) & ~3;
+            const int dst_stride = (width + 3) & ~3;
 
-            for (int i = 0; i + 2 < data.size(); i += 3) {
-                const uint8_t b = data[i];
-                const uint8_t g = data[i + 1];
-                const uint8_t r = data[i + 2];
+            PixelBuffer new_data(dst_stride * height, 0);
 
-                auto new_color = static_cast<uint8_t>(0.3 * r + 0.59 * g + 0.11 * b);
+            for (int y = 0; y < height; ++y) {
+                const uint8_t* src = data.data() + y * src_stride;
+                uint8_t* dst = new_data.data() + y * dst_stride;
 
-                new_data.push_back(new_color);
+                for (int x = 0; x < width; ++x, src += 3) {
+                    dst[x] = luminance(src[0], src[1], src[2]);
+                }
             }
 
             data.swap(new_data);
@@ -75,21 +90,22 @@ namespace bmp {
         }
     };
 
-    class BmpConverterIndexed8BitToMonochrome final : public BmpConverter {
+    // Shared header and palette handling of every conversion that ends in a 1-bit image
+    class BmpConverterToMonochrome : public BmpConverter {
+    protected:
         BmpHeader& file_header;
         BmpInfoHeader& info_header;
-        std::vector<uint8_t>& data;
+        PixelBuffer& data;
         Palette& palette;
-        const int p;
 
         void change_headers() const override {
-            const int bits_per_row = info_header.width;
-            const int row_stride = (bits_per_row + 7) / 8 + 3 & ~3;
+            const int row_stride = ((info_header.width + 31) / 32) * 4;
 
-            info_header.size_image = row_stride * info_header.height;
+            info_header.size_image = row_stride * std::abs(info_header.height);
 
             info_header.bit_count = 1;
             file_header.offset = calculate_offset();
+            file_header.file_size = file_header.offset + info_header.size_image;
         }
 
         uint32_t calculate_offset() const override {
@@ -108,21 +124,36 @@ namespace bmp {
                     static_cast<uint8_t>(255), static_cast<uint8_t>(0)}
             );
         }
-    public:
 
-        explicit BmpConverterIndexed8BitToMonochrome(
+    public:
+        BmpConverterToMonochrome(
             BmpImage*& bmp_image,
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& data,
-            Palette& palette,
-            const int p = 127
+            PixelBuffer& data,
+            Palette& palette
         ) :
         BmpConverter(bmp_image),
         file_header(file_header),
         info_header(info_header),
         data(data),
-        palette(palette),
+        palette(palette) {}
+    };
+
+    class BmpConverterIndexed8BitToMonochrome final : public BmpConverterToMonochrome {
+        const int p;
+
+    public:
+
+        explicit BmpConverterIndexed8BitToMonochrome(
+            BmpImage*& bmp_image,
+            BmpHeader& file_header,
+            BmpInfoHeader& info_header,
+            PixelBuffer& data,
+            Palette& palette,
+            const int p = 127
+        ) :
+        BmpConverterToMonochrome(bmp_image, file_header, info_header, data, palette),
         p(p) {}
 
         void convert() override {
@@ -132,27 +163,160 @@ namespace bmp {
             const int width = info_header.width;
             const int height = std::abs(info_header.height);
             const int bits_per_row = width;
+            const int src_stride = (width + 3) & ~3;
             const int row_stride = ((bits_per_row + 31) / 32) * 4; // выравнивание до ближайших 4 байт
-            std::vector<uint8_t> new_data(height * row_stride, 0);
+            PixelBuffer new_data(height * row_stride, 0);
 
             for (int y = 0; y < height; ++y) {
+                const uint8_t* src = data.data() + y * src_stride;
+                uint8_t* dst = new_data.data() + y * row_stride;
+
                 for (int x = 0; x < width; x += 8) {
                     uint8_t byte = 0;
                     for (int bit = 0; bit < 8 && x + bit < width; ++bit) {
-                        int pixel_index = y * width + x + bit;
-                        if (data[pixel_index] >= p) {
+                        if (src[x + bit] >= p) {
                             byte |= 1 << (7 - bit);
                         }
                     }
 
-                    int byte_index_in_row = x / 8;
-                    new_data[y * row_stride + byte_index_in_row] = byte;
+                    dst[x / 8] = byte;
+                }
+            }
+
+            data.swap(new_data);
+        }
+
+    };
+
+    // RGB -> 1 bit in a single pass: luminance is computed, thresholded and packed per row,
+    // so no intermediate 8-bit buffer is ever allocated
+    class BmpConverterRgbToMonochrome final : public BmpConverterToMonochrome {
+        const int p;
+
+    public:
+
+        explicit BmpConverterRgbToMonochrome(
+            BmpImage*& bmp_image,
+            BmpHeader& file_header,
+            BmpInfoHeader& info_header,
+            PixelBuffer& data,
+            Palette& palette,
+            const int p = 127
+        ) :
+        BmpConverterToMonochrome(bmp_image, file_header, info_header, data, palette),
+        p(p) {}
+
+        void convert() override {
+            if (bmp_image == nullptr) {
+                throw std::invalid_argument("BmpConverterRgbToMonochrome: image is null");
+            }
+
+            const int width = info_header.width;
+            const int height = std::abs(info_header.height);
+            const int src_stride = (width * 3 + 3) & ~3;
+            const int row_stride = ((width + 31) / 32) * 4;
+
+            PixelBuffer new_data(height * row_stride, 0);
+
+            for (int y = 0; y < height; ++y) {
+                const uint8_t* src = data.data() + y * src_stride;
+                uint8_t* dst = new_data.data() + y * row_stride;
+
+                int x = 0;
+                for (; x + 8 <= width; x += 8, src += 24) {
+                    uint8_t byte = 0;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        const uint8_t* pixel = src + bit * 3;
+                        const bool is_white = luminance(pixel[0], pixel[1], pixel[2]) >= p;
+                        byte |= static_cast<uint8_t>(is_white) << (7 - bit);
+                    }
+                    dst[x / 8] = byte;
+                }
+
+                if (x < width) {
+                    uint8_t byte = 0;
+                    for (int bit = 0; x + bit < width; ++bit, src += 3) {
+                        if (luminance(src[0], src[1], src[2]) >= p) {
+                            byte |= 1 << (7 - bit);
+                        }
+                    }
+                    dst[x / 8] = byte;
                 }
             }
 
+            delete bmp_image;
+            bmp_image = new IndexedBmpImage(file_header, info_header, data, palette);
+
             data.swap(new_data);
+
+            change_palette();
+            change_headers();
         }
+    };
+
+    // 8 bit -> 1 bit with a threshold that follows the local mean (and deviation) of each pixel's
+    // window, read from a summed-area table built in one pass over the image
+    class BmpConverterIndexed8BitToMonochromeAdaptive final : public BmpConverterToMonochrome {
+        const AdaptiveThresholdParameters parameters;
 
+        template<typename Sum>
+        void pack(PixelBuffer& new_data, const int row_stride) const {
+            const int width = info_header.width;
+            const int height = std::abs(info_header.height);
+            const int src_stride = (width + 3) & ~3;
+            const ConstImageView source {data.data(), width, height, src_stride, 8};
+            const IntegralImage<Sum> integral(source, parameters.method == AdaptiveThresholdMethod::SAUVOLA);
+
+            parallel::for_each_range(0, height, [&](const int64_t first, const int64_t last) {
+                std::vector<uint8_t> is_white(width);
+
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    adaptive_threshold_row(integral, source.row(y), y, parameters, is_white.data());
+
+                    uint8_t* dst = new_data.data() + y * row_stride;
+                    for (int x = 0; x < width; ++x) {
+                        dst[x / 8] |= static_cast<uint8_t>(is_white[x] << (7 - x % 8));
+                    }
+                }
+            }, 16);
+        }
+
+    public:
+
+        explicit BmpConverterIndexed8BitToMonochromeAdaptive(
+            BmpImage*& bmp_image,
+            BmpHeader& file_header,
+            BmpInfoHeader& info_header,
+            PixelBuffer& data,
+            Palette& palette,
+            const AdaptiveThresholdParameters& parameters
+        ) :
+        BmpConverterToMonochrome(bmp_image, file_header, info_header, data, palette),
+        parameters(parameters) {}
+
+        void convert() override {
+            if (parameters.radius < 0) {
+                throw std::invalid_argument("BmpConverterIndexed8BitToMonochromeAdaptive: radius must not be negative");
+            }
+
+            const int width = info_header.width;
+            const int height = std::abs(info_header.height);
+            const int row_stride = ((width + 31) / 32) * 4;
+            const bool with_squares = parameters.method == AdaptiveThresholdMethod::SAUVOLA;
+
+            PixelBuffer new_data(height * row_stride, 0);
+
+            if (IntegralImage<uint32_t>::fits(width, height, with_squares)) {
+                pack<uint32_t>(new_data, row_stride);
+            } else {
+                pack<uint64_t>(new_data, row_stride);
+            }
+
+            data.swap(new_data);
+
+            change_palette();
+            change_headers();
+        }
     };
 }
 
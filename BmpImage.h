@@ -2,10 +2,13 @@
 #define BMP_IMAGE_H
 
 #include "managing_structs.h"
+#include "PixelBuffer.h"
 #include <fstream>
 #include <vector>
 #include <unordered_map>
 #include <cmath>
+#include <cstdint>
+#include <stdexcept>
 
 namespace  bmp {
     class BmpImage {
@@ -13,7 +16,7 @@ namespace  bmp {
         BmpHeader& file_header;
         BmpInfoHeader& info_header;
 
-        std::vector<uint8_t>& data;
+        PixelBuffer& data;
 
         void check_type_of_file_header() const {
             if (file_header.file_type != 0x4d42) {
@@ -25,7 +28,7 @@ namespace  bmp {
         BmpImage(
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& file_data
+            PixelBuffer& file_data
         ) :
             file_header(file_header), info_header(info_header), data(file_data) {}
 
@@ -35,7 +38,37 @@ namespace  bmp {
 
         [[nodiscard]] BmpInfoHeader& get_info_header() const { return info_header; }
 
-        [[nodiscard]] std::vector<uint8_t>& get_data() const { return data; }
+        [[nodiscard]] PixelBuffer& get_data() const { return data; }
+
+    protected:
+        // extra_header_bytes: whatever follows the info header (color masks, palette)
+        void allocate_blank(const int32_t width, const int32_t height, const uint16_t bit_count,
+                            const uint32_t extra_header_bytes) {
+            if (width <= 0 || height <= 0) {
+                throw std::invalid_argument("Image dimensions must be positive");
+            }
+            const uint64_t row_stride = (static_cast<uint64_t>(width) * bit_count + 31) / 32 * 4;
+            const uint64_t size_image = row_stride * static_cast<uint64_t>(height);
+            const uint64_t offset = sizeof(BmpHeader) + sizeof(BmpInfoHeader) + extra_header_bytes;
+            if (offset + size_image > UINT32_MAX) {
+                throw std::length_error("Image too large for a BMP file");
+            }
+
+            info_header = BmpInfoHeader {};
+            info_header.size = sizeof(BmpInfoHeader);
+            info_header.width = width;
+            info_header.height = height;
+            info_header.bit_count = bit_count;
+            info_header.size_image = static_cast<uint32_t>(size_image);
+
+            file_header.offset = static_cast<uint32_t>(offset);
+            file_header.file_size = static_cast<uint32_t>(offset + size_image);
+
+            PixelBuffer().swap(data);
+            data.resize(size_image);
+        }
+
+    public:
 
         virtual void read_headers(std::ifstream& file) {
             file.read(reinterpret_cast<char *>(&file_header), sizeof(file_header));
@@ -94,9 +127,9 @@ namespace  bmp {
 
         virtual void gamma_correct(int gamma) = 0;
 
-        virtual void create_blank() = 0;
-
-        virtual void draw_pixel_black(uint32_t index) = 0;
+        // Headers of a width x height image of this type with every pixel zero. The rows are
+        // left to the zero pages of the pixel buffer, so nothing is written to them here
+        virtual void create_blank(int32_t width, int32_t height, uint16_t bit_count) = 0;
 
         //[[nodiscard]] uint8_t get_byte_value(const uint index) const {
           //  return data[index];
@@ -108,7 +141,7 @@ namespace  bmp {
         RgbBmpImage(
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& file_data
+            PixelBuffer& file_data
         ): BmpImage(file_header, info_header, file_data) {}
 
         void read_headers(std::ifstream& file) override {
@@ -130,7 +163,7 @@ namespace  bmp {
         }
 
         void change_brightness(const int brightness) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 if (byte + brightness > 255 || byte + brightness < 0) {
                     new_data.push_back(byte);
@@ -144,7 +177,7 @@ namespace  bmp {
         }
 
         void transform_to_negative() override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = 255 - byte;
                 new_data.push_back(to_add);
@@ -154,7 +187,7 @@ namespace  bmp {
         }
 
         void transform_to_negative(const int p) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 if (byte < p) {
                     new_data.push_back(byte);
@@ -167,7 +200,7 @@ namespace  bmp {
         }
 
         void increase_contrast(const uint8_t q1, const uint8_t q2) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>((byte - q1) * 255 / (q2 - q1));
                 new_data.push_back(to_add);
@@ -176,7 +209,7 @@ namespace  bmp {
         }
 
         void decrease_contrast(const uint8_t q1, const uint8_t q2) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>(q1 + byte * (q2 - q1) / 255);
                 new_data.push_back(to_add);
@@ -185,7 +218,7 @@ namespace  bmp {
         }
 
         void gamma_correct(const int gamma) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
 
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>(255 * pow(byte / 255.0, gamma));
@@ -195,35 +228,11 @@ namespace  bmp {
             data.swap(new_data);
         }
 
-        void create_blank() override {
-            const int32_t width = info_header.width = 1080;
-            const int32_t height = info_header.height = 720;
-            const uint32_t bits = info_header.bit_count = 24;
-
-            const uint32_t row_stride = ((width * bits + 31) / 32) * 4;
-            info_header.size_image = row_stride * height;
-
-            info_header.size = sizeof(BmpInfoHeader);
-
-            data.resize(info_header.size_image);
-
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x) {
-                    size_t index = y * row_stride + x * 3;
-                    data[index + 0] = 255; // Blue
-                    data[index + 1] = 255; // Green
-                    data[index + 2] = 255; // Red
-                }
+        void create_blank(const int32_t width, const int32_t height, const uint16_t bit_count) override {
+            if (bit_count != 24) {
+                throw std::invalid_argument("RGB images have 24 bits per pixel");
             }
-
-            file_header.file_size = sizeof(BmpHeader) + sizeof(BmpInfoHeader) + info_header.size_image;
-            file_header.offset = sizeof(BmpHeader) + sizeof(BmpInfoHeader);
-        }
-
-        void draw_pixel_black(const uint32_t index) override {
-            data[index] = 0;
-            data[index + 1] = 0;
-            data[index + 2] = 0;
+            allocate_blank(width, height, bit_count, 0);
         }
     };
 
@@ -256,7 +265,7 @@ namespace  bmp {
         ArgbBmpImage(
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& file_data,
+            PixelBuffer& file_data,
             BmpColorHeader& color_header
             )
         : BmpImage(file_header, info_header, file_data), color_header(color_header) {}
@@ -280,9 +289,16 @@ namespace  bmp {
         void decrease_contrast(const uint8_t q1, const uint8_t q2) override {}
         void gamma_correct(const int gamma) override {}
 
-        void create_blank() override {}
-
-        void draw_pixel_black(const uint32_t index) override {}
+        void create_blank(const int32_t width, const int32_t height, const uint16_t bit_count) override {
+            if (bit_count != 32) {
+                throw std::invalid_argument("BGRA images have 32 bits per pixel");
+            }
+            constexpr uint32_t BI_BITFIELDS = 3;
+            color_header = BmpColorHeader {};
+            allocate_blank(width, height, bit_count, sizeof(BmpColorHeader));
+            info_header.size += sizeof(BmpColorHeader);
+            info_header.compression = BI_BITFIELDS;
+        }
     };
 
     class IndexedBmpImage final : public BmpImage {
@@ -292,7 +308,7 @@ namespace  bmp {
         IndexedBmpImage(
             BmpHeader& file_header,
             BmpInfoHeader& info_header,
-            std::vector<uint8_t>& file_data,
+            PixelBuffer& file_data,
             Palette& palette
         ) : BmpImage(file_header, info_header, file_data), palette(palette) {}
 
@@ -318,7 +334,7 @@ namespace  bmp {
         }
 
         void change_brightness(const int brightness) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 if (byte + brightness > 255 || byte + brightness < 0) {
                     new_data.push_back(byte);
@@ -332,7 +348,7 @@ namespace  bmp {
         }
 
         void transform_to_negative() override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = 255 - byte;
                 new_data.push_back(to_add);
@@ -342,7 +358,7 @@ namespace  bmp {
         }
 
         void transform_to_negative(const int p) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 if (byte < p) {
                     new_data.push_back(byte);
@@ -355,7 +371,7 @@ namespace  bmp {
         }
 
         void increase_contrast(const uint8_t q1, const uint8_t q2) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>((byte - q1) * 255 / (q2 - q1));
                 new_data.push_back(to_add);
@@ -364,7 +380,7 @@ namespace  bmp {
         }
 
         void decrease_contrast(const uint8_t q1, const uint8_t q2) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>(q1 + byte * (q2 - q1) / 255);
                 new_data.push_back(to_add);
@@ -373,7 +389,7 @@ namespace  bmp {
         }
 
         void gamma_correct(const int gamma) override {
-            std::vector<uint8_t> new_data;
+            PixelBuffer new_data;
 
             for (const auto byte : data) {
                 const auto to_add = static_cast<uint8_t>(255 * pow(byte / 255.0, gamma));
@@ -383,9 +399,19 @@ namespace  bmp {
             data.swap(new_data);
         }
 
-        void create_blank() override {}
-
-        void draw_pixel_black(const uint32_t index) override {}
+        // The palette is a gray ramp from black (index 0) to white (the last index)
+        void create_blank(const int32_t width, const int32_t height, const uint16_t bit_count) override {
+            if (bit_count != 1 && bit_count != 2 && bit_count != 4 && bit_count != 8) {
+                throw std::invalid_argument("Indexed images have 1, 2, 4 or 8 bits per pixel");
+            }
+            const int levels = 1 << bit_count;
+            palette.colors.clear();
+            for (int i = 0; i < levels; ++i) {
+                const auto gray = static_cast<byte>(i * 255 / (levels - 1));
+                palette.colors.push_back({gray, gray, gray, 0});
+            }
+            allocate_blank(width, height, bit_count, levels * sizeof(Color));
+        }
     };
 }
 
@@ -2,11 +2,32 @@
 #define BRESENHAM_ALGORITHM_EXECUTOR_H
 
 #include "Drawer.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
 
 namespace curve_algorithms {
 
+// Sorts the spans of out from index first on by row and column and joins those that overlap or
+// touch, so that no pixel is listed twice
+inline void merge_spans(std::vector<drawing::Span>& out, const size_t first) {
+    const auto begin = out.begin() + static_cast<std::ptrdiff_t>(first);
+    std::sort(begin, out.end(), [](const drawing::Span& a, const drawing::Span& b) {
+        return a.row < b.row || (a.row == b.row && a.begin < b.begin);
+    });
+    auto merged = begin;
+    for (auto span = begin; span != out.end(); ++span) {
+        if (merged != begin && (merged - 1)->row == span->row && (merged - 1)->end >= span->begin) {
+            (merged - 1)->end = std::max((merged - 1)->end, span->end);
+        } else {
+            *merged++ = *span;
+        }
+    }
+    out.erase(merged, out.end());
+}
+
 class BresenhamAlgorithmExecutor {
 protected:
     drawing::Drawer* drawer;
@@ -16,6 +37,9 @@ public:
     explicit BresenhamAlgorithmExecutor(drawing::Drawer* drawer) : drawer(drawer) {}
 
     virtual void execute() = 0;
+
+    // Draws onto the drawer's canvas without saving it
+    virtual void rasterize() = 0;
 };
 
 
@@ -36,10 +60,24 @@ class LineSegmentBresenhamAlgorithmExecutor final: public BresenhamAlgorithmExec
     uint32_t j0;
     uint32_t j1;
 
-    void draw_point(const uint32_t x, const uint32_t y) const {
-        drawer->draw(drawing::Point(x, y));
+    std::vector<drawing::Span> spans;
+
+    // Index of the first step whose minor offset reaches m: the inverse of
+    // minor(k) = (2 * d_minor * k + d_major) / (2 * d_major)
+    static int64_t first_step_with_minor(const int64_t m, const uint64_t d_major, const uint64_t d_minor) {
+        if (m <= 0) {
+            return 0;
+        }
+        if (static_cast<uint64_t>(m) > d_minor) {
+            return static_cast<int64_t>(d_major);
+        }
+        const uint64_t numerator = d_major * (2 * static_cast<uint64_t>(m) - 1);
+        return static_cast<int64_t>((numerator + 2 * d_minor - 1) / (2 * d_minor));
     }
+
 public:
+    static constexpr int64_t COORDINATE_LIMIT = int64_t {1} << 30;
+
     LineSegmentBresenhamAlgorithmExecutor(
         drawing::Drawer* drawer,
         const uint32_t i0,
@@ -50,54 +88,176 @@ public:
     ) : BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)), i0(i0), i1(i1), j0(j0), j1(j1) {}
 
     void execute() override {
-        int c;
-        int d_i = static_cast<int>(i1) - i0;
-        int d_j = static_cast<int>(j1) - j0;
+        rasterize();
+        save();
+    }
 
-        const int8_t sign_1 = sign(d_i);
-        const int8_t sign_2 = sign(d_j);
+    void rasterize() override {
+        spans.clear();
+        append_spans(
+            static_cast<int32_t>(i0), static_cast<int32_t>(j0),
+            static_cast<int32_t>(i1), static_cast<int32_t>(j1),
+            drawer->get_canvas_height(), drawer->get_canvas_width(),
+            spans
+        );
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    static int8_t sign(const int32_t x) {
+        return (x > 0) - (x < 0);
+    }
 
-        d_i = abs(d_i);
-        d_j = abs(d_j);
+    // Appends the pixels of the segment from (i0, j0) up to, but excluding, (i1, j1) that fall on a
+    // height x width canvas; i is the row and j the column. Coordinates are signed, so endpoints
+    // computed as "c - r" that went below zero are clipped instead of wrapping around.
+    //
+    // Step k of the major axis lands on minor offset (2 * d_minor * k + d_major) / (2 * d_major),
+    // the same pixels the incremental error term picks. The canvas bounds on both axes are turned
+    // into a range of k (Liang-Barsky clipping done exactly, in steps), and the pixels in that
+    // range are produced a whole run of constant minor offset at a time (run-slice Bresenham).
+    static void append_spans(
+        const int32_t i0,
+        const int32_t j0,
+        const int32_t i1,
+        const int32_t j1,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        for (const int32_t coordinate : {i0, j0, i1, j1}) {
+            if (coordinate <= -COORDINATE_LIMIT || coordinate >= COORDINATE_LIMIT) {
+                throw std::out_of_range("Line endpoint coordinates must stay within 2^30");
+            }
+        }
 
-        if (d_j > d_i) {
-            std::swap(d_i, d_j);
-            c = 1;
+        const bool major_is_row = std::abs(static_cast<int64_t>(j1) - j0) <= std::abs(static_cast<int64_t>(i1) - i0);
+        const int64_t a0 = major_is_row ? i0 : j0;
+        const int64_t b0 = major_is_row ? j0 : i0;
+        const int64_t a_extent = major_is_row ? height : width;
+        const int64_t b_extent = major_is_row ? width : height;
+        const int64_t d_a = (major_is_row ? static_cast<int64_t>(i1) : j1) - a0;
+        const int64_t d_b = (major_is_row ? static_cast<int64_t>(j1) : i1) - b0;
+        const int8_t s_a = d_a < 0 ? -1 : 1;
+        const int8_t s_b = d_b < 0 ? -1 : 1;
+        const auto length = static_cast<uint64_t>(std::abs(d_a));
+        const auto d_minor = static_cast<uint64_t>(std::abs(d_b));
+
+        if (length == 0) {
+            return;
+        }
+
+        // Major axis: a0 + s_a * k must lie in [0, a_extent)
+        int64_t k_first = 0;
+        int64_t k_last = static_cast<int64_t>(length) - 1;
+        if (s_a > 0) {
+            k_first = std::max(k_first, -a0);
+            k_last = std::min(k_last, a_extent - 1 - a0);
         } else {
-            c = 0;
+            k_first = std::max(k_first, a0 - (a_extent - 1));
+            k_last = std::min(k_last, a0);
+        }
+
+        // Minor axis: b0 + s_b * m must lie in [0, b_extent), and m never decreases with k
+        const int64_t m_low = s_b > 0 ? -b0 : b0 - (b_extent - 1);
+        const int64_t m_high = s_b > 0 ? b_extent - 1 - b0 : b0;
+        if (m_high < 0 || m_low > static_cast<int64_t>(d_minor)) {
+            return;
         }
+        k_first = std::max(k_first, first_step_with_minor(m_low, length, d_minor));
+        k_last = std::min(k_last, first_step_with_minor(m_high + 1, length, d_minor) - 1);
 
-        int e  = 2 * d_j - d_i;
-
-        uint32_t i = i0;
-        uint32_t j = j0;
-        for (int k = 0; k < d_i; ++k) {
-            draw_point(i ,j);
-            while (e >= 0) {
-                if (c == 1) {
-                    i += sign_1;
-                } else {
-                    j += sign_2;
-                }
-                e -= 2 * d_i;
+        if (k_first > k_last) {
+            return;
+        }
+
+        // Steps are written through a pointer into space reserved up front; the carry of an error
+        // term decides when the minor coordinate moves, so the loops have no data-dependent branches
+        const size_t first_new = out.size();
+        const uint64_t steps = static_cast<uint64_t>(k_last - k_first) + 1;
+
+        if (major_is_row) {
+            // Steep: every row holds one pixel, m(k) = (2 * d_minor * k + length) / (2 * length)
+            out.resize(first_new + steps);
+            drawing::Span* span = out.data() + first_new;
+
+            const uint64_t two_length = 2 * length;
+            auto column = static_cast<int32_t>(b0);
+            uint64_t error = length;
+            if (k_first > 0) {
+                const uint64_t numerator = 2 * d_minor * static_cast<uint64_t>(k_first) + length;
+                column = static_cast<int32_t>(b0 + s_b * static_cast<int64_t>(numerator / two_length));
+                error = numerator % two_length;
             }
-            if (c == 1) {
-                j += sign_2;
-            } else {
-                i += sign_1;
+            auto row = static_cast<int32_t>(a0 + s_a * k_first);
+
+            for (uint64_t step = 0; step < steps; ++step, ++span) {
+                *span = {row, column, column + 1};
+                row += s_a;
+                error += 2 * d_minor;
+                const bool carry = error >= two_length;
+                error -= carry ? two_length : 0;
+                column += carry ? s_b : 0;
             }
-            e += 2 * d_j;
+            return;
         }
 
-        save();
-    }
+        if (d_minor == 0) {
+            const auto row = static_cast<int32_t>(b0);
+            out.push_back(s_a > 0
+                ? drawing::Span {row, static_cast<int32_t>(a0 + k_first), static_cast<int32_t>(a0 + k_last + 1)}
+                : drawing::Span {row, static_cast<int32_t>(a0 - k_last), static_cast<int32_t>(a0 - k_first + 1)});
+            return;
+        }
 
-    void save() override {
-        drawer->save(filename);
-    }
+        // Shallow: run m ends before step ceil(length * (2m + 1) / (2 * d_minor)). That end and its slack
+        // below the exact product are carried from run to run: runs are length / d_minor steps long or
+        // one longer, so a single division serves the whole line (run-slice Bresenham)
+        out.resize(first_new + std::min<uint64_t>(steps, d_minor + 1));
+        drawing::Span* span = out.data() + first_new;
+
+        const auto divisor = static_cast<int64_t>(2 * d_minor);
+        // Both fit in 32 bits, where division is several times cheaper
+        const auto step_quotient = static_cast<int64_t>(static_cast<uint32_t>(length) / static_cast<uint32_t>(d_minor));
+        const auto step_remainder = static_cast<int64_t>(2 * (static_cast<uint32_t>(length) % static_cast<uint32_t>(d_minor)));
+
+        int64_t m = 0;
+        int64_t run_end = step_quotient / 2;
+        int64_t slack = step_quotient % 2 * static_cast<int64_t>(d_minor) + step_remainder / 2;
+        if (k_first > 0) {
+            m = static_cast<int64_t>((2 * d_minor * static_cast<uint64_t>(k_first) + length) / (2 * length));
+            const uint64_t numerator = length * (2 * static_cast<uint64_t>(m) + 1);
+            run_end = static_cast<int64_t>(numerator / static_cast<uint64_t>(divisor));
+            slack = static_cast<int64_t>(numerator % static_cast<uint64_t>(divisor));
+        }
+        if (slack > 0) {
+            ++run_end;
+            slack = divisor - slack;
+        }
 
-    static int8_t sign(const int32_t x) {
-        return (x > 0) - (x < 0);
+        auto row = static_cast<int32_t>(b0 + s_b * m);
+        int64_t k = k_first;
+        while (true) {
+            const int64_t last = std::min(run_end, k_last + 1) - 1;
+            const int64_t from = a0 + s_a * k;
+            const int64_t to = a0 + s_a * last;
+            *span++ = {row, static_cast<int32_t>(std::min(from, to)), static_cast<int32_t>(std::max(from, to) + 1)};
+            if (last == k_last) {
+                break;
+            }
+
+            k = last + 1;
+            row += s_b;
+            run_end += step_quotient;
+            slack -= step_remainder;
+            const bool borrow = slack < 0;
+            run_end += borrow;
+            slack += borrow ? divisor : 0;
+        }
+        out.resize(static_cast<size_t>(span - out.data()));
     }
 };
 
@@ -106,8 +266,10 @@ class CircleBresenhamAlgorithmExecutor final: public BresenhamAlgorithmExecutorW
     uint32_t cy;
     uint32_t r;
 
-    void draw_point(const uint32_t x, const uint32_t y) const {
-        drawer->draw(drawing::Point(x, y));
+    std::vector<drawing::Point> points;
+
+    void draw_point(const uint32_t x, const uint32_t y) {
+        points.emplace_back(x, y);
     }
 
 public:
@@ -124,11 +286,19 @@ public:
         r(r) {}
 
     void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
         uint x = 0;
         uint y = r;
 
         int sd = 2 - 2 * r;
 
+        points.clear();
+        points.reserve(8 * (r + 1));
+
         while (y >= x) {
             draw_circle_points(cx, cy, x, y);
 
@@ -147,10 +317,10 @@ public:
             sd += 2 * (++x - --y);
         }
 
-        drawer->save(filename);
+        drawer->draw(points);
     }
 
-    void draw_circle_points(const int cx, const int cy, const int x, const int y) const {
+    void draw_circle_points(const int cx, const int cy, const int x, const int y) {
         draw_point(cx + x, cy + y);
         draw_point(cx - x, cy + y);
         draw_point(cx + x, cy - y);
@@ -0,0 +1,213 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include "ImageView.h"
+#include "Point.h"
+
+namespace drawing {
+
+    // Memory layout of one BMP pixel format, known at compile time. Colors are encoded as in
+    // ConnectedComponents: a palette index for indexed formats, blue | green << 8 | red << 16 for
+    // direct ones, channels stored in that order; drawing leaves the alpha of 32-bit pixels alone.
+    // Packed formats keep the leftmost pixel in the most significant bits of a byte.
+    template<uint16_t Bits>
+    struct PixelFormat {
+        static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8 || Bits == 24 || Bits == 32,
+                      "Unsupported BMP bit count");
+
+        static constexpr uint16_t BIT_COUNT = Bits;
+        static constexpr bool PACKED = Bits < 8;
+        static constexpr int PIXELS_PER_BYTE = PACKED ? 8 / Bits : 1;
+        static constexpr int BYTES_PER_PIXEL = PACKED ? 0 : Bits / 8;
+        static constexpr bool INDEXED = Bits <= 8;
+        static constexpr int COLOR_CHANNELS = INDEXED ? 1 : 3;
+        static constexpr bool HAS_ALPHA = Bits == 32;
+        static constexpr int BLUE = 0;
+        static constexpr int GREEN = 1;
+        static constexpr int RED = 2;
+        static constexpr int ALPHA = 3;
+    };
+
+    using Monochrome = PixelFormat<1>;
+    using Indexed2 = PixelFormat<2>;
+    using Indexed4 = PixelFormat<4>;
+    using Indexed8 = PixelFormat<8>;
+    using Bgr24 = PixelFormat<24>;
+    using Bgra32 = PixelFormat<32>;
+
+    // Typed window onto an image: every store is resolved at compile time, so plotting a pixel
+    // inlines to a single store (a masked one for packed formats). Spans and coverage off the
+    // canvas are clipped.
+    template<typename Format>
+    class Canvas {
+        bmp::ImageView view;
+
+        // The byte a packed pixel lives in, and its bits within that byte
+        static constexpr uint8_t packed_mask(const int32_t column) {
+            const int shift = 8 - Format::BIT_COUNT * (column % Format::PIXELS_PER_BYTE + 1);
+            return static_cast<uint8_t>(((1 << Format::BIT_COUNT) - 1) << shift);
+        }
+
+        // The value repeated over a whole byte, for packed runs
+        static constexpr uint8_t packed_byte(const uint32_t value) {
+            uint8_t byte = 0;
+            for (int i = 0; i < Format::PIXELS_PER_BYTE; ++i) {
+                byte = static_cast<uint8_t>(byte << Format::BIT_COUNT | (value & ((1 << Format::BIT_COUNT) - 1)));
+            }
+            return byte;
+        }
+
+        // round(x / 255) for x in [0, 255 * 255]
+        static constexpr uint32_t div255(const uint32_t x) {
+            return ((x + 128) * 257) >> 16;
+        }
+
+        void store(uint8_t* row, const int32_t column, const uint32_t value) const {
+            if constexpr (Format::PACKED) {
+                const uint8_t mask = packed_mask(column);
+                uint8_t& byte = row[column / Format::PIXELS_PER_BYTE];
+                byte = static_cast<uint8_t>((byte & ~mask) | (packed_byte(value) & mask));
+            } else if constexpr (Format::BYTES_PER_PIXEL == 1) {
+                row[column] = static_cast<uint8_t>(value);
+            } else {
+                uint8_t* pixel = row + column * Format::BYTES_PER_PIXEL;
+                pixel[Format::BLUE] = static_cast<uint8_t>(value);
+                pixel[Format::GREEN] = static_cast<uint8_t>(value >> 8);
+                pixel[Format::RED] = static_cast<uint8_t>(value >> 16);
+            }
+        }
+
+        void store_run(uint8_t* row, const int32_t begin, const int32_t end, const uint32_t value) const {
+            if constexpr (Format::PACKED) {
+                int32_t column = begin;
+                for (; column < end && column % Format::PIXELS_PER_BYTE != 0; ++column) {
+                    store(row, column, value);
+                }
+                const int32_t whole_end = column + (end - column) / Format::PIXELS_PER_BYTE * Format::PIXELS_PER_BYTE;
+                if (whole_end > column) {
+                    std::memset(row + column / Format::PIXELS_PER_BYTE, packed_byte(value),
+                                static_cast<size_t>(whole_end - column) / Format::PIXELS_PER_BYTE);
+                    column = whole_end;
+                }
+                for (; column < end; ++column) {
+                    store(row, column, value);
+                }
+            } else if constexpr (Format::BYTES_PER_PIXEL == 1) {
+                std::memset(row + begin, static_cast<uint8_t>(value), static_cast<size_t>(end - begin));
+            } else if constexpr (Format::BYTES_PER_PIXEL == 3) {
+                const auto blue = static_cast<uint8_t>(value);
+                if (end - begin > 4 && blue == static_cast<uint8_t>(value >> 8) && blue == static_cast<uint8_t>(value >> 16)) {
+                    std::memset(row + begin * 3, blue, static_cast<size_t>(end - begin) * 3);
+                    return;
+                }
+                // Runs of sloped lines are a few pixels long; a call to memset costs more than the stores
+                for (int32_t column = begin; column < end; ++column) {
+                    store(row, column, value);
+                }
+            } else {
+                for (int32_t column = begin; column < end; ++column) {
+                    store(row, column, value);
+                }
+            }
+        }
+
+    public:
+        using format = Format;
+
+        explicit Canvas(const bmp::ImageView& view) : view(view) {
+            if (view.bit_count != Format::BIT_COUNT) {
+                throw std::invalid_argument("Canvas: the image has a different pixel format");
+            }
+        }
+
+        [[nodiscard]] int32_t get_width() const {
+            return view.width;
+        }
+
+        [[nodiscard]] int32_t get_height() const {
+            return view.height;
+        }
+
+        [[nodiscard]] bool contains(const int32_t row, const int32_t column) const {
+            return row >= 0 && row < view.height && column >= 0 && column < view.width;
+        }
+
+        // No bounds check: the caller has already clipped
+        void plot(const int32_t row, const int32_t column, const uint32_t value) const {
+            store(view.row(row), column, value);
+        }
+
+        void fill(const Span& span, const uint32_t value) const {
+            const int32_t begin = std::max(span.begin, 0);
+            const int32_t end = std::min(span.end, view.width);
+            if (span.row < 0 || span.row >= view.height || begin >= end) {
+                return;
+            }
+            store_run(view.row(span.row), begin, end, value);
+        }
+
+        void fill(const std::span<const Span> spans, const uint32_t value) const {
+            for (const Span& span : spans) {
+                fill(span, value);
+            }
+        }
+
+        // c' = (value * alpha + c * (255 - alpha)) / 255 per color channel, rounded exactly. 8-bit
+        // images are taken to carry a grayscale palette, so the index is blended as a gray level.
+        // Packed pixels have no levels between palette entries and are set where the coverage
+        // reaches one half.
+        void blend(const Coverage& pixel, const uint32_t value) const {
+            if (!contains(pixel.row, pixel.column)) {
+                return;
+            }
+            if constexpr (Format::PACKED) {
+                if (pixel.alpha >= 128) {
+                    plot(pixel.row, pixel.column, value);
+                }
+            } else {
+                const uint32_t alpha = pixel.alpha;
+                const uint32_t inverse = 255 - alpha;
+                uint8_t* target = view.row(pixel.row) + pixel.column * Format::BYTES_PER_PIXEL;
+                for (int c = 0; c < Format::COLOR_CHANNELS; ++c) {
+                    const uint32_t ink = (value >> (8 * c)) & 0xFF;
+                    target[c] = static_cast<uint8_t>(div255(ink * alpha + target[c] * inverse));
+                }
+            }
+        }
+
+        void blend(const std::span<const Coverage> pixels, const uint32_t value) const {
+            for (const Coverage& pixel : pixels) {
+                blend(pixel, value);
+            }
+        }
+    };
+
+    // The only place the pixel format is looked up at run time: calls operation with the Canvas
+    // matching the view's bit count
+    template<typename Operation>
+    decltype(auto) with_canvas(const bmp::ImageView& view, Operation&& operation) {
+        switch (view.bit_count) {
+            case 1:
+                return operation(Canvas<Monochrome>(view));
+            case 2:
+                return operation(Canvas<Indexed2>(view));
+            case 4:
+                return operation(Canvas<Indexed4>(view));
+            case 8:
+                return operation(Canvas<Indexed8>(view));
+            case 24:
+                return operation(Canvas<Bgr24>(view));
+            case 32:
+                return operation(Canvas<Bgra32>(view));
+            default:
+                throw std::runtime_error("Canvas: unsupported bit count");
+        }
+    }
+}
+
+#endif
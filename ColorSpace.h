@@ -0,0 +1,363 @@
+#ifndef COLOR_SPACE_H
+#define COLOR_SPACE_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace bmp {
+
+    // Three same-sized planes of one component each, e.g. Y/Cb/Cr or L/a/b
+    template<typename T>
+    struct ColorPlanes {
+        int32_t width {0};
+        int32_t height {0};
+        std::array<std::vector<T>, 3> planes;
+
+        ColorPlanes() = default;
+
+        ColorPlanes(const int32_t width, const int32_t height) : width(width), height(height) {
+            for (auto& plane : planes) {
+                plane.resize(static_cast<size_t>(width) * height);
+            }
+        }
+
+        [[nodiscard]] T* row(const int plane, const int32_t y) { return planes[plane].data() + static_cast<size_t>(y) * width; }
+
+        [[nodiscard]] const T* row(const int plane, const int32_t y) const { return planes[plane].data() + static_cast<size_t>(y) * width; }
+    };
+
+    // Conversions between interleaved BGR(A) rows and planar YCbCr (BT.601 full range, 16-bit
+    // fixed point), HSV and CIE Lab (D65). Alpha is neither read nor written. The in-place
+    // adjustments convert one row into small scratch buffers, edit it and convert it straight
+    // back, so no full-size image in the other space is ever allocated.
+    class ColorSpace {
+        static constexpr int SHIFT = 16;
+        static constexpr int32_t HALF = 1 << (SHIFT - 1);
+
+        static constexpr int32_t fixed(const double value) {
+            return static_cast<int32_t>(value * (1 << SHIFT) + (value < 0 ? -0.5 : 0.5));
+        }
+
+        static uint8_t saturate(const int32_t value) {
+            return static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+
+        static void check_view(const ConstImageView& view) {
+            if (view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("ColorSpace: only 24 and 32-bit images are supported");
+            }
+        }
+
+        template<typename Rows>
+        static void for_each_row_range(const int32_t height, Rows&& rows) {
+            parallel::for_each_range(0, height, [&](const int64_t first, const int64_t last) {
+                rows(static_cast<int32_t>(first), static_cast<int32_t>(last));
+            }, 16);
+        }
+
+        // ---- YCbCr ----
+
+        static void bgr_row_to_ycbcr(const uint8_t* bgr, const int channels, const int32_t width,
+                                     uint8_t* y_row, uint8_t* cb_row, uint8_t* cr_row) {
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const int32_t b = bgr[0];
+                const int32_t g = bgr[1];
+                const int32_t r = bgr[2];
+                y_row[x] = saturate((fixed(0.299) * r + fixed(0.587) * g + fixed(0.114) * b + HALF) >> SHIFT);
+                cb_row[x] = saturate(((-fixed(0.168736) * r - fixed(0.331264) * g + fixed(0.5) * b + HALF) >> SHIFT) + 128);
+                cr_row[x] = saturate(((fixed(0.5) * r - fixed(0.418688) * g - fixed(0.081312) * b + HALF) >> SHIFT) + 128);
+            }
+        }
+
+        static void ycbcr_row_to_bgr(const uint8_t* y_row, const uint8_t* cb_row, const uint8_t* cr_row,
+                                     const int32_t width, uint8_t* bgr, const int channels) {
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const int32_t luma = y_row[x] << SHIFT;
+                const int32_t cb = cb_row[x] - 128;
+                const int32_t cr = cr_row[x] - 128;
+                bgr[0] = saturate((luma + fixed(1.772) * cb + HALF) >> SHIFT);
+                bgr[1] = saturate((luma - fixed(0.344136) * cb - fixed(0.714136) * cr + HALF) >> SHIFT);
+                bgr[2] = saturate((luma + fixed(1.402) * cr + HALF) >> SHIFT);
+            }
+        }
+
+        // ---- HSV ----
+
+        static void bgr_row_to_hsv(const uint8_t* bgr, const int channels, const int32_t width,
+                                   float* h_row, float* s_row, float* v_row) {
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const float b = bgr[0] / 255.0f;
+                const float g = bgr[1] / 255.0f;
+                const float r = bgr[2] / 255.0f;
+                const float max = std::max({r, g, b});
+                const float min = std::min({r, g, b});
+                const float delta = max - min;
+
+                float hue = 0.0f;
+                if (delta > 0.0f) {
+                    if (max == r) {
+                        hue = 60.0f * (g - b) / delta;
+                    } else if (max == g) {
+                        hue = 60.0f * (b - r) / delta + 120.0f;
+                    } else {
+                        hue = 60.0f * (r - g) / delta + 240.0f;
+                    }
+                    if (hue < 0.0f) {
+                        hue += 360.0f;
+                    }
+                }
+
+                h_row[x] = hue;
+                s_row[x] = max > 0.0f ? delta / max : 0.0f;
+                v_row[x] = max;
+            }
+        }
+
+        static void hsv_row_to_bgr(const float* h_row, const float* s_row, const float* v_row,
+                                   const int32_t width, uint8_t* bgr, const int channels) {
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const float value = v_row[x];
+                const float chroma = value * std::clamp(s_row[x], 0.0f, 1.0f);
+                const float sector = h_row[x] / 60.0f;
+                const float second = chroma * (1.0f - std::abs(std::fmod(sector, 2.0f) - 1.0f));
+                const float m = value - chroma;
+
+                float r = 0.0f;
+                float g = 0.0f;
+                float b = 0.0f;
+                switch (static_cast<int>(sector) % 6) {
+                    case 0: r = chroma; g = second; break;
+                    case 1: r = second; g = chroma; break;
+                    case 2: g = chroma; b = second; break;
+                    case 3: g = second; b = chroma; break;
+                    case 4: r = second; b = chroma; break;
+                    default: r = chroma; b = second; break;
+                }
+
+                bgr[0] = saturate(static_cast<int32_t>((b + m) * 255.0f + 0.5f));
+                bgr[1] = saturate(static_cast<int32_t>((g + m) * 255.0f + 0.5f));
+                bgr[2] = saturate(static_cast<int32_t>((r + m) * 255.0f + 0.5f));
+            }
+        }
+
+        // ---- Lab ----
+
+        struct SrgbTables {
+            std::array<float, 256> to_linear {};
+            std::array<float, 256> encode_bounds {};   // linear value halfway between consecutive codes
+
+            SrgbTables() {
+                auto linearize = [](const double value) {
+                    return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+                };
+                for (int i = 0; i < 256; ++i) {
+                    to_linear[i] = static_cast<float>(linearize(i / 255.0));
+                    encode_bounds[i] = static_cast<float>(linearize((i + 0.5) / 255.0));
+                }
+            }
+        };
+
+        static const SrgbTables& srgb() {
+            static const SrgbTables tables;
+            return tables;
+        }
+
+        // Exact inverse of the table: the code whose linear interval contains the value
+        static uint8_t encode_srgb(const float linear) {
+            const auto& bounds = srgb().encode_bounds;
+            return static_cast<uint8_t>(std::lower_bound(bounds.begin(), bounds.end() - 1, linear) - bounds.begin());
+        }
+
+        static constexpr float WHITE_X = 0.95047f;
+        static constexpr float WHITE_Z = 1.08883f;
+        static constexpr float EPSILON = 216.0f / 24389.0f;
+        static constexpr float KAPPA = 24389.0f / 27.0f;
+
+        static float lab_f(const float t) {
+            return t > EPSILON ? std::cbrt(t) : (KAPPA * t + 16.0f) / 116.0f;
+        }
+
+        static float lab_f_inverse(const float t) {
+            const float cube = t * t * t;
+            return cube > EPSILON ? cube : (116.0f * t - 16.0f) / KAPPA;
+        }
+
+        static void bgr_row_to_lab(const uint8_t* bgr, const int channels, const int32_t width,
+                                   float* l_row, float* a_row, float* b_row) {
+            const auto& linear = srgb().to_linear;
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const float b = linear[bgr[0]];
+                const float g = linear[bgr[1]];
+                const float r = linear[bgr[2]];
+
+                const float fx = lab_f((0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / WHITE_X);
+                const float fy = lab_f(0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+                const float fz = lab_f((0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / WHITE_Z);
+
+                l_row[x] = 116.0f * fy - 16.0f;
+                a_row[x] = 500.0f * (fx - fy);
+                b_row[x] = 200.0f * (fy - fz);
+            }
+        }
+
+        static void lab_row_to_bgr(const float* l_row, const float* a_row, const float* b_row,
+                                   const int32_t width, uint8_t* bgr, const int channels) {
+            for (int32_t x = 0; x < width; ++x, bgr += channels) {
+                const float fy = (l_row[x] + 16.0f) / 116.0f;
+                const float fx = fy + a_row[x] / 500.0f;
+                const float fz = fy - b_row[x] / 200.0f;
+
+                const float x_value = lab_f_inverse(fx) * WHITE_X;
+                const float y_value = lab_f_inverse(fy);
+                const float z_value = lab_f_inverse(fz) * WHITE_Z;
+
+                bgr[2] = encode_srgb(3.2404542f * x_value - 1.5371385f * y_value - 0.4985314f * z_value);
+                bgr[1] = encode_srgb(-0.9692660f * x_value + 1.8760108f * y_value + 0.0415560f * z_value);
+                bgr[0] = encode_srgb(0.0556434f * x_value - 0.2040259f * y_value + 1.0572252f * z_value);
+            }
+        }
+
+        template<typename T, typename Convert>
+        static ColorPlanes<T> to_planes(const ConstImageView& src, Convert&& convert) {
+            check_view(src);
+            ColorPlanes<T> planes(src.width, src.height);
+            const int channels = src.bytes_per_pixel();
+
+            for_each_row_range(src.height, [&](const int32_t first, const int32_t last) {
+                for (int32_t y = first; y < last; ++y) {
+                    convert(src.row(y), channels, src.width, planes.row(0, y), planes.row(1, y), planes.row(2, y));
+                }
+            });
+            return planes;
+        }
+
+        template<typename T, typename Convert>
+        static void from_planes(const ColorPlanes<T>& planes, const ImageView& dst, Convert&& convert) {
+            check_view(dst);
+            if (planes.width != dst.width || planes.height != dst.height) {
+                throw std::invalid_argument("ColorSpace: planes and image dimensions differ");
+            }
+            const int channels = dst.bytes_per_pixel();
+
+            for_each_row_range(dst.height, [&](const int32_t first, const int32_t last) {
+                for (int32_t y = first; y < last; ++y) {
+                    convert(planes.row(0, y), planes.row(1, y), planes.row(2, y), dst.width, dst.row(y), channels);
+                }
+            });
+        }
+
+        // Converts one row out, lets edit change it, converts it back into the same row
+        template<typename T, typename Forward, typename Backward, typename Edit>
+        static void edit_rows(const ImageView& view, Forward&& forward, Backward&& backward, Edit&& edit) {
+            check_view(view);
+            const int channels = view.bytes_per_pixel();
+
+            for_each_row_range(view.height, [&](const int32_t first, const int32_t last) {
+                std::vector<T> scratch(3 * static_cast<size_t>(view.width));
+                T* c0 = scratch.data();
+                T* c1 = c0 + view.width;
+                T* c2 = c1 + view.width;
+
+                for (int32_t y = first; y < last; ++y) {
+                    forward(view.row(y), channels, view.width, c0, c1, c2);
+                    edit(c0, c1, c2, view.width);
+                    backward(c0, c1, c2, view.width, view.row(y), channels);
+                }
+            });
+        }
+
+    public:
+        static ColorPlanes<uint8_t> to_ycbcr(const ConstImageView& src) {
+            return to_planes<uint8_t>(src, bgr_row_to_ycbcr);
+        }
+
+        static void from_ycbcr(const ColorPlanes<uint8_t>& planes, const ImageView& dst) {
+            from_planes(planes, dst, ycbcr_row_to_bgr);
+        }
+
+        // H in degrees [0, 360), S and V in [0, 1]
+        static ColorPlanes<float> to_hsv(const ConstImageView& src) {
+            return to_planes<float>(src, bgr_row_to_hsv);
+        }
+
+        static void from_hsv(const ColorPlanes<float>& planes, const ImageView& dst) {
+            from_planes(planes, dst, hsv_row_to_bgr);
+        }
+
+        // L in [0, 100], a and b roughly in [-128, 127]
+        static ColorPlanes<float> to_lab(const ConstImageView& src) {
+            return to_planes<float>(src, bgr_row_to_lab);
+        }
+
+        static void from_lab(const ColorPlanes<float>& planes, const ImageView& dst) {
+            from_planes(planes, dst, lab_row_to_bgr);
+        }
+
+        // Brightness that leaves chroma alone, so colors do not wash out towards grey. With Cb and Cr
+        // fixed, a shift of Y by delta is a shift of every channel by delta, so it is applied in RGB
+        // and a zero delta changes nothing. A pixel the shift would push out of range keeps its hue:
+        // Y is clamped and the color moves towards grey only as far as needed to fit.
+        static void adjust_luma(const ImageView& view, const int delta) {
+            check_view(view);
+            const int channels = view.bytes_per_pixel();
+
+            for_each_row_range(view.height, [&](const int32_t first, const int32_t last) {
+                for (int32_t y = first; y < last; ++y) {
+                    uint8_t* bgr = view.row(y);
+                    for (int32_t x = 0; x < view.width; ++x, bgr += channels) {
+                        const int32_t low = std::min({bgr[0], bgr[1], bgr[2]}) + delta;
+                        const int32_t high = std::max({bgr[0], bgr[1], bgr[2]}) + delta;
+                        if (low >= 0 && high <= 255) {
+                            for (int c = 0; c < 3; ++c) {
+                                bgr[c] = static_cast<uint8_t>(bgr[c] + delta);
+                            }
+                            continue;
+                        }
+
+                        const double luma = 0.299 * bgr[2] + 0.587 * bgr[1] + 0.114 * bgr[0];
+                        const double shifted = std::clamp(luma + delta, 0.0, 255.0);
+                        double scale = 1.0;
+                        for (int c = 0; c < 3; ++c) {
+                            const double offset = bgr[c] - luma;
+                            if (offset > 0.0) {
+                                scale = std::min(scale, (255.0 - shifted) / offset);
+                            } else if (offset < 0.0) {
+                                scale = std::min(scale, shifted / -offset);
+                            }
+                        }
+                        for (int c = 0; c < 3; ++c) {
+                            bgr[c] = saturate(static_cast<int32_t>(std::lround(shifted + scale * (bgr[c] - luma))));
+                        }
+                    }
+                }
+            });
+        }
+
+        static void scale_saturation(const ImageView& view, const float factor) {
+            edit_rows<float>(view, bgr_row_to_hsv, hsv_row_to_bgr,
+                [factor](float*, float* saturation, float*, const int32_t width) {
+                    for (int32_t x = 0; x < width; ++x) {
+                        saturation[x] = std::clamp(saturation[x] * factor, 0.0f, 1.0f);
+                    }
+                });
+        }
+
+        // Perceptual lightness shift in Lab, delta in L units (0..100)
+        static void adjust_lightness(const ImageView& view, const float delta) {
+            edit_rows<float>(view, bgr_row_to_lab, lab_row_to_bgr,
+                [delta](float* lightness, float*, float*, const int32_t width) {
+                    for (int32_t x = 0; x < width; ++x) {
+                        lightness[x] = std::clamp(lightness[x] + delta, 0.0f, 100.0f);
+                    }
+                });
+        }
+    };
+}
+
+#endif
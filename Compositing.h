@@ -0,0 +1,214 @@
+#ifndef COMPOSITING_H
+#define COMPOSITING_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bmp {
+
+    enum class BlendMode {
+        OVER,       // Porter-Duff source over destination, weighted by the source alpha
+        ADD,        // saturating sum
+        MULTIPLY,   // s * d, darkens
+        SCREEN,     // s + d - s * d, lightens
+        BLEND       // constant-alpha mix: the source alpha channel is ignored
+    };
+
+    // Places a 24 or 32-bit source onto a 24 or 32-bit destination. Every mode computes a blended
+    // color B from s and d, which only applies where the destination is opaque: the source color
+    // becomes b = (s * (255 - d_a) + B * d_a) / 255. Then Porter-Duff over with the source alpha a,
+    // scaled by the opacity, gives d_a' = a + d_a * (255 - a) / 255 and
+    // d' = (b * a * 255 + d * d_a * (255 - a)) / (255 * d_a'). Alpha is straight (not
+    // premultiplied) as in BGRA bitmaps, and 24-bit destinations count as opaque, where d' reduces
+    // to (b * a + d * (255 - a)) / 255. All divisions are exact roundings.
+    class Compositor {
+        // round(x / 255) for x in [0, 255 * 255]
+        static uint32_t div255(const uint32_t x) {
+            return ((x + 128) * 257) >> 16;
+        }
+
+        static uint8_t blend_channel(const BlendMode mode, const uint32_t s, const uint32_t d) {
+            switch (mode) {
+                case BlendMode::ADD:
+                    return static_cast<uint8_t>(std::min<uint32_t>(s + d, 255));
+                case BlendMode::MULTIPLY:
+                    return static_cast<uint8_t>(div255(s * d));
+                case BlendMode::SCREEN:
+                    return static_cast<uint8_t>(s + d - div255(s * d));
+                default:
+                    return static_cast<uint8_t>(s);
+            }
+        }
+
+        static void composite_scalar(const uint8_t* src, uint8_t* dst, const int32_t count,
+                                     const BlendMode mode, const uint32_t opacity) {
+            for (int32_t x = 0; x < count; ++x, src += 4, dst += 4) {
+                const uint32_t a = mode == BlendMode::BLEND ? opacity : div255(src[3] * opacity);
+                if (a == 0) {
+                    continue;
+                }
+                const uint32_t destination_alpha = dst[3];
+                const uint32_t source_weight = a * 255;
+                const uint32_t destination_weight = destination_alpha * (255 - a);
+                const uint32_t total = source_weight + destination_weight;
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t blended = blend_channel(mode, src[c], dst[c]);
+                    const uint32_t b = div255(src[c] * (255 - destination_alpha) + blended * destination_alpha);
+                    dst[c] = static_cast<uint8_t>((b * source_weight + dst[c] * destination_weight + total / 2) / total);
+                }
+                dst[3] = static_cast<uint8_t>(div255(255 * a + destination_alpha * (255 - a)));
+            }
+        }
+
+#if defined(__SSE2__)
+        // Exact for x in [0, 255 * 255]: (x + 128) * 257 >> 16 is the high half of a 16-bit product
+        static __m128i div255_epu16(const __m128i x) {
+            return _mm_mulhi_epu16(_mm_add_epi16(x, _mm_set1_epi16(128)), _mm_set1_epi16(257));
+        }
+
+        // Four BGRA pixels widened to 16-bit lanes, two pixels per register
+        static __m128i composite_half(const __m128i s, const __m128i d, const __m128i blended_bytes_half,
+                                      const BlendMode mode, const __m128i opacity) {
+            __m128i a;
+            if (mode == BlendMode::BLEND) {
+                a = opacity;
+            } else {
+                const __m128i source_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+                a = div255_epu16(_mm_mullo_epi16(source_alpha, opacity));
+            }
+
+            __m128i b;
+            switch (mode) {
+                case BlendMode::ADD:
+                    b = blended_bytes_half;
+                    break;
+                case BlendMode::MULTIPLY:
+                    b = div255_epu16(_mm_mullo_epi16(s, d));
+                    break;
+                case BlendMode::SCREEN:
+                    b = _mm_sub_epi16(_mm_add_epi16(s, d), div255_epu16(_mm_mullo_epi16(s, d)));
+                    break;
+                default:
+                    b = s;
+                    break;
+            }
+            // The destination is opaque here, so the alpha lane blends towards opaque and stays 255
+            b = _mm_or_si128(b, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+
+            const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), a);
+            return div255_epu16(_mm_add_epi16(_mm_mullo_epi16(b, a), _mm_mullo_epi16(d, inverse)));
+        }
+
+        // Only opaque destination pixels take the vector path; a group of four with any translucent
+        // one goes through the scalar kernel, which divides by the resulting alpha
+        static int32_t composite_simd(const uint8_t* src, uint8_t* dst, const int32_t count,
+                                      const BlendMode mode, const uint32_t opacity) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i opacity_lanes = _mm_set1_epi16(static_cast<int16_t>(opacity));
+            const __m128i color_bits = _mm_set1_epi32(0x00FFFFFF);
+            const __m128i all_bits = _mm_set1_epi32(-1);
+
+            int32_t x = 0;
+            for (; x + 4 <= count; x += 4) {
+                const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x * 4));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(d, color_bits), all_bits)) != 0xFFFF) {
+                    composite_scalar(src + x * 4, dst + x * 4, 4, mode, opacity);
+                    continue;
+                }
+                const __m128i sum = _mm_adds_epu8(s, d);
+
+                const __m128i low = composite_half(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+                                                   _mm_unpacklo_epi8(sum, zero), mode, opacity_lanes);
+                const __m128i high = composite_half(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+                                                    _mm_unpackhi_epi8(sum, zero), mode, opacity_lanes);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(low, high));
+            }
+            return x;
+        }
+#endif
+
+        static void composite_row(const uint8_t* src, uint8_t* dst, const int32_t count,
+                                  const BlendMode mode, const uint32_t opacity) {
+            int32_t done = 0;
+#if defined(__SSE2__)
+            done = composite_simd(src, dst, count, mode, opacity);
+#endif
+            composite_scalar(src + done * 4, dst + done * 4, count - done, mode, opacity);
+        }
+
+        // 24-bit rows are widened to BGRA with an opaque alpha so one kernel serves every format
+        static const uint8_t* widen(const uint8_t* row, const int bytes_per_pixel, const int32_t count, uint8_t* scratch) {
+            if (bytes_per_pixel == 4) {
+                return row;
+            }
+            for (int32_t x = 0; x < count; ++x) {
+                scratch[x * 4] = row[x * 3];
+                scratch[x * 4 + 1] = row[x * 3 + 1];
+                scratch[x * 4 + 2] = row[x * 3 + 2];
+                scratch[x * 4 + 3] = 255;
+            }
+            return scratch;
+        }
+
+        static void narrow(const uint8_t* scratch, const int32_t count, uint8_t* row) {
+            for (int32_t x = 0; x < count; ++x) {
+                row[x * 3] = scratch[x * 4];
+                row[x * 3 + 1] = scratch[x * 4 + 1];
+                row[x * 3 + 2] = scratch[x * 4 + 2];
+            }
+        }
+
+    public:
+        // The source's top-left pixel lands on column left, row top of the destination; either may be
+        // negative and whatever falls outside the destination is dropped. src and dst must not overlap.
+        static void composite(const ConstImageView& src, const ImageView& dst, const int32_t left, const int32_t top,
+                              const BlendMode mode, const uint8_t opacity = 255) {
+            for (const uint16_t bit_count : {src.bit_count, dst.bit_count}) {
+                if (bit_count != 24 && bit_count != 32) {
+                    throw std::runtime_error("Compositor: only 24 and 32-bit images can be composited");
+                }
+            }
+
+            const int32_t x0 = std::max(0, left);
+            const int32_t y0 = std::max(0, top);
+            const int32_t x1 = static_cast<int32_t>(std::min<int64_t>(dst.width, static_cast<int64_t>(left) + src.width));
+            const int32_t y1 = static_cast<int32_t>(std::min<int64_t>(dst.height, static_cast<int64_t>(top) + src.height));
+            if (x0 >= x1 || y0 >= y1) {
+                return;
+            }
+
+            const int32_t count = x1 - x0;
+            const int src_bytes = src.bytes_per_pixel();
+            const int dst_bytes = dst.bytes_per_pixel();
+
+            parallel::for_each_range(y0, y1, [&](const int64_t first, const int64_t last) {
+                std::vector<uint8_t> src_scratch(src_bytes == 4 ? 0 : static_cast<size_t>(count) * 4);
+                std::vector<uint8_t> dst_scratch(dst_bytes == 4 ? 0 : static_cast<size_t>(count) * 4);
+
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* in = widen(src.row(y - top) + (x0 - left) * src_bytes, src_bytes, count, src_scratch.data());
+                    uint8_t* out = dst.row(y) + x0 * dst_bytes;
+
+                    if (dst_bytes == 4) {
+                        composite_row(in, out, count, mode, opacity);
+                        continue;
+                    }
+                    widen(out, dst_bytes, count, dst_scratch.data());
+                    composite_row(in, dst_scratch.data(), count, mode, opacity);
+                    narrow(dst_scratch.data(), count, out);
+                }
+            }, 16);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef CONNECTED_COMPONENTS_H
+#define CONNECTED_COMPONENTS_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace bmp {
+
+    enum class Connectivity {
+        FOUR,   // edge neighbours only
+        EIGHT   // edge and corner neighbours
+    };
+
+    // Pixels belong to the same component when they are connected and have the same value:
+    // the palette index of indexed images, or blue | green << 8 | red << 16 for 24 and 32-bit
+    // ones (alpha is ignored). Every pixel gets a label, the background included.
+    struct Component {
+        uint32_t value {0};
+        uint64_t area {0};
+        int32_t left {0};       // bounding box, inclusive
+        int32_t top {0};
+        int32_t right {0};
+        int32_t bottom {0};
+    };
+
+    struct ComponentLabels {
+        int32_t width {0};
+        int32_t height {0};
+        std::vector<uint32_t> labels;           // row after row, top row first
+        std::vector<Component> components;      // indexed by label, in raster order of their first pixel
+
+        [[nodiscard]] uint32_t at(const int32_t x, const int32_t y) const {
+            return labels[static_cast<size_t>(y) * width + x];
+        }
+    };
+
+    // Union-find over pixel indices. Every row strip is labeled independently in parallel, then
+    // the rows on both sides of each strip boundary are merged. A root is always the smallest
+    // index of its set, so parents point backwards and one raster pass turns them into labels.
+    class ConnectedComponents {
+        static uint32_t find(std::vector<uint32_t>& parent, uint32_t i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        }
+
+        static void unite(std::vector<uint32_t>& parent, const uint32_t a, const uint32_t b) {
+            const uint32_t root_a = find(parent, a);
+            const uint32_t root_b = find(parent, b);
+            if (root_a < root_b) {
+                parent[root_b] = root_a;
+            } else if (root_b < root_a) {
+                parent[root_a] = root_b;
+            }
+        }
+
+        static uint32_t value_at(const ConstImageView& view, const int32_t x, const int32_t y) {
+            const uint8_t* row = view.row(y);
+            if (view.bit_count < 8) {
+                const int bits = view.bit_count;
+                const int per_byte = 8 / bits;
+                return (row[x / per_byte] >> (8 - bits * (x % per_byte + 1))) & ((1 << bits) - 1);
+            }
+            if (view.bit_count == 8) {
+                return row[x];
+            }
+            const uint8_t* pixel = row + x * view.bytes_per_pixel();
+            return pixel[0] | pixel[1] << 8 | pixel[2] << 16;
+        }
+
+        static void read_values(const ConstImageView& view, const int32_t y, std::vector<uint32_t>& values) {
+            const uint8_t* row = view.row(y);
+
+            if (view.bit_count < 8) {
+                const int bits = view.bit_count;
+                const int per_byte = 8 / bits;
+                const auto mask = static_cast<uint8_t>((1 << bits) - 1);
+                for (int32_t x = 0; x < view.width; ++x) {
+                    values[x] = (row[x / per_byte] >> (8 - bits * (x % per_byte + 1))) & mask;
+                }
+            } else if (view.bit_count == 8) {
+                std::copy_n(row, view.width, values.begin());
+            } else {
+                const int bytes_per_pixel = view.bytes_per_pixel();
+                for (int32_t x = 0; x < view.width; ++x, row += bytes_per_pixel) {
+                    values[x] = row[0] | row[1] << 8 | row[2] << 16;
+                }
+            }
+        }
+
+        // Joins every pixel of the lower row with its equal-valued neighbours in the upper row
+        static void unite_rows(std::vector<uint32_t>& parent, const std::vector<uint32_t>& upper_values,
+                               const std::vector<uint32_t>& lower_values, const uint32_t upper_start,
+                               const uint32_t lower_start, const int32_t width, const Connectivity connectivity) {
+            for (int32_t x = 0; x < width; ++x) {
+                const uint32_t value = lower_values[x];
+                if (upper_values[x] == value) {
+                    unite(parent, lower_start + x, upper_start + x);
+                }
+                if (connectivity == Connectivity::EIGHT) {
+                    if (x > 0 && upper_values[x - 1] == value) {
+                        unite(parent, lower_start + x, upper_start + x - 1);
+                    }
+                    if (x + 1 < width && upper_values[x + 1] == value) {
+                        unite(parent, lower_start + x, upper_start + x + 1);
+                    }
+                }
+            }
+        }
+
+        static void label_strip(const ConstImageView& view, std::vector<uint32_t>& parent, const int32_t first,
+                                const int32_t last, const Connectivity connectivity) {
+            std::vector<uint32_t> previous(view.width);
+            std::vector<uint32_t> current(view.width);
+
+            for (int32_t y = first; y < last; ++y) {
+                read_values(view, y, current);
+                const auto start = static_cast<uint32_t>(static_cast<size_t>(y) * view.width);
+
+                // A run of equal values hangs off its first pixel
+                for (int32_t x = 0; x < view.width; ++x) {
+                    parent[start + x] = x > 0 && current[x] == current[x - 1] ? parent[start + x - 1] : start + x;
+                }
+                if (y > first) {
+                    unite_rows(parent, previous, current, start - view.width, start, view.width, connectivity);
+                }
+                previous.swap(current);
+            }
+        }
+
+    public:
+        static ComponentLabels label(const ConstImageView& view, const Connectivity connectivity = Connectivity::FOUR) {
+            if (view.bit_count != 1 && view.bit_count != 2 && view.bit_count != 4 &&
+                view.bit_count != 8 && view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("ConnectedComponents: unsupported bit count");
+            }
+            const auto pixel_count = static_cast<uint64_t>(view.width) * view.height;
+            if (pixel_count >= std::numeric_limits<uint32_t>::max()) {
+                throw std::overflow_error("ConnectedComponents: image has too many pixels");
+            }
+
+            ComponentLabels result;
+            result.width = view.width;
+            result.height = view.height;
+            result.labels.resize(pixel_count);
+            std::vector<uint32_t>& parent = result.labels;
+
+            const int64_t strip_height = std::max<int64_t>(64, (view.height + parallel::thread_count() - 1) / parallel::thread_count());
+            const int64_t strips = (view.height + strip_height - 1) / strip_height;
+
+            parallel::for_each_range(0, strips, [&](const int64_t first, const int64_t last) {
+                for (int64_t strip = first; strip < last; ++strip) {
+                    label_strip(view, parent, static_cast<int32_t>(strip * strip_height),
+                                static_cast<int32_t>(std::min<int64_t>((strip + 1) * strip_height, view.height)), connectivity);
+                }
+            });
+
+            std::vector<uint32_t> upper(view.width);
+            std::vector<uint32_t> lower(view.width);
+            for (int64_t strip = 1; strip < strips; ++strip) {
+                const auto y = static_cast<int32_t>(strip * strip_height);
+                read_values(view, y - 1, upper);
+                read_values(view, y, lower);
+                const auto start = static_cast<uint32_t>(static_cast<size_t>(y) * view.width);
+                unite_rows(parent, upper, lower, start - view.width, start, view.width, connectivity);
+            }
+
+            // parent[i] <= i, so parent[i] has already been replaced by its final label
+            std::vector<uint32_t> roots;
+            for (uint32_t i = 0; i < pixel_count; ++i) {
+                const auto x = static_cast<int32_t>(i % view.width);
+                const auto y = static_cast<int32_t>(i / view.width);
+
+                if (parent[i] == i) {
+                    parent[i] = static_cast<uint32_t>(result.components.size());
+                    roots.push_back(i);
+                    Component component;
+                    component.left = component.right = x;
+                    component.top = component.bottom = y;
+                    result.components.push_back(component);
+                } else {
+                    parent[i] = parent[parent[i]];
+                }
+
+                Component& component = result.components[parent[i]];
+                ++component.area;
+                component.left = std::min(component.left, x);
+                component.right = std::max(component.right, x);
+                component.bottom = y;
+            }
+
+            for (size_t label = 0; label < result.components.size(); ++label) {
+                result.components[label].value = value_at(view, roots[label] % view.width, roots[label] / view.width);
+            }
+
+            return result;
+        }
+
+        // Writes value (encoded as in Component::value) into every pixel of the component
+        static void fill(const ImageView& view, const ComponentLabels& labels, const uint32_t label, const uint32_t value) {
+            if (labels.width != view.width || labels.height != view.height) {
+                throw std::invalid_argument("ConnectedComponents: labels do not match the image");
+            }
+            if (label >= labels.components.size()) {
+                throw std::out_of_range("ConnectedComponents: no such component");
+            }
+
+            const Component& component = labels.components[label];
+            const int bytes_per_pixel = view.bytes_per_pixel();
+
+            parallel::for_each_range(component.top, component.bottom + 1, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    uint8_t* row = view.row(y);
+                    for (int32_t x = component.left; x <= component.right; ++x) {
+                        if (labels.at(x, y) != label) {
+                            continue;
+                        }
+                        if (view.bit_count < 8) {
+                            const int bits = view.bit_count;
+                            const int per_byte = 8 / bits;
+                            const int shift = 8 - bits * (x % per_byte + 1);
+                            const auto mask = static_cast<uint8_t>(((1 << bits) - 1) << shift);
+                            uint8_t& byte = row[x / per_byte];
+                            byte = static_cast<uint8_t>((byte & ~mask) | ((value << shift) & mask));
+                        } else if (view.bit_count == 8) {
+                            row[x] = static_cast<uint8_t>(value);
+                        } else {
+                            uint8_t* pixel = row + x * bytes_per_pixel;
+                            pixel[0] = static_cast<uint8_t>(value);
+                            pixel[1] = static_cast<uint8_t>(value >> 8);
+                            pixel[2] = static_cast<uint8_t>(value >> 16);
+                        }
+                    }
+                }
+            }, 64);
+        }
+    };
+}
+
+#endif
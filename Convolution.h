@@ -0,0 +1,336 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bmp {
+
+    enum class BorderMode {
+        CLAMP,      // aaa|abcd|ddd
+        REFLECT,    // dcb|abcd|cba
+        WRAP,       // bcd|abcd|abc
+        CONSTANT    // kkk|abcd|kkk
+    };
+
+    // Maps a coordinate outside [0, size) to the source coordinate the border mode reads from,
+    // or -1 when the constant border value should be used instead
+    inline int32_t map_border_index(int32_t index, const int32_t size, const BorderMode mode) {
+        if (index >= 0 && index < size) {
+            return index;
+        }
+
+        switch (mode) {
+            case BorderMode::CLAMP:
+                return std::clamp(index, 0, size - 1);
+            case BorderMode::REFLECT: {
+                if (size == 1) {
+                    return 0;
+                }
+                const int32_t period = 2 * (size - 1);
+                index = std::abs(index) % period;
+                return index < size ? index : period - index;
+            }
+            case BorderMode::WRAP:
+                index %= size;
+                return index < 0 ? index + size : index;
+            case BorderMode::CONSTANT:
+                return -1;
+        }
+        return -1;
+    }
+
+    // Copies source row y into padded (pad pixels on each side) applying the border mode
+    inline void pad_row(const ConstImageView& src, const int32_t y, const int32_t pad,
+                        const BorderMode border, const uint8_t border_value, uint8_t* padded) {
+        const int channels = src.bytes_per_pixel();
+        const int32_t source_y = map_border_index(y, src.height, border);
+
+        if (source_y < 0) {
+            std::fill_n(padded, static_cast<size_t>(src.width + 2 * pad) * channels, border_value);
+            return;
+        }
+
+        const uint8_t* row = src.row(source_y);
+        std::copy_n(row, static_cast<size_t>(src.width) * channels, padded + pad * channels);
+
+        for (int32_t i = 1; i <= pad; ++i) {
+            const int32_t left = map_border_index(-i, src.width, border);
+            const int32_t right = map_border_index(src.width - 1 + i, src.width, border);
+            uint8_t* left_pixel = padded + (pad - i) * channels;
+            uint8_t* right_pixel = padded + (pad + src.width - 1 + i) * channels;
+            for (int c = 0; c < channels; ++c) {
+                left_pixel[c] = left < 0 ? border_value : row[left * channels + c];
+                right_pixel[c] = right < 0 ? border_value : row[right * channels + c];
+            }
+        }
+    }
+
+    // Dense 2D kernel with odd dimensions, anchored at its centre
+    class Kernel {
+        int32_t width;
+        int32_t height;
+        std::vector<float> weights;
+
+    public:
+        Kernel(const int32_t width, const int32_t height, std::vector<float> weights) :
+            width(width), height(height), weights(std::move(weights)) {
+            if (width <= 0 || height <= 0 || width % 2 == 0 || height % 2 == 0) {
+                throw std::invalid_argument("Kernel: dimensions must be positive and odd");
+            }
+            if (this->weights.size() != static_cast<size_t>(width) * height) {
+                throw std::invalid_argument("Kernel: number of weights does not match its dimensions");
+            }
+        }
+
+        static Kernel sharpen() {
+            return {3, 3, {0, -1, 0, -1, 5, -1, 0, -1, 0}};
+        }
+
+        static Kernel edge_detect() {
+            return {3, 3, {-1, -1, -1, -1, 8, -1, -1, -1, -1}};
+        }
+
+        static Kernel emboss() {
+            return {3, 3, {-2, -1, 0, -1, 1, 1, 0, 1, 2}};
+        }
+
+        [[nodiscard]] int32_t get_width() const { return width; }
+
+        [[nodiscard]] int32_t get_height() const { return height; }
+
+        [[nodiscard]] float at(const int32_t x, const int32_t y) const { return weights[y * width + x]; }
+    };
+
+    // Integer taps of a separable kernel. Weights are non-negative, so a row pass whose weights sum
+    // to at most 257 fits 255 * sum into 16 bits exactly and runs on 16-bit lanes.
+    struct SeparableKernel {
+        std::vector<uint32_t> horizontal;
+        std::vector<uint32_t> vertical;
+
+        static SeparableKernel box(const int32_t radius) {
+            if (radius < 0) {
+                throw std::invalid_argument("SeparableKernel: radius must not be negative");
+            }
+            std::vector<uint32_t> taps(2 * radius + 1, 1);
+            return {taps, taps};
+        }
+
+        // Taps quantized to sum to 256; the centre tap absorbs the rounding error
+        static SeparableKernel gaussian(const double sigma) {
+            if (sigma <= 0.0) {
+                throw std::invalid_argument("SeparableKernel: sigma must be positive");
+            }
+
+            const auto radius = static_cast<int32_t>(std::ceil(3.0 * sigma));
+            std::vector<double> exact(2 * radius + 1);
+            double sum = 0.0;
+            for (int32_t i = -radius; i <= radius; ++i) {
+                exact[i + radius] = std::exp(-0.5 * i * i / (sigma * sigma));
+                sum += exact[i + radius];
+            }
+
+            std::vector<uint32_t> taps(exact.size());
+            int64_t quantized_sum = 0;
+            for (size_t i = 0; i < exact.size(); ++i) {
+                taps[i] = static_cast<uint32_t>(std::lround(256.0 * exact[i] / sum));
+                quantized_sum += taps[i];
+            }
+            taps[radius] = static_cast<uint32_t>(static_cast<int64_t>(taps[radius]) + 256 - quantized_sum);
+
+            return {taps, taps};
+        }
+    };
+
+    class ConvolutionFilter {
+        static constexpr int32_t BAND_HEIGHT = 32;
+
+        static void check_view(const ConstImageView& view) {
+            if (view.bit_count != 8 && view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("ConvolutionFilter: only 8, 24 and 32-bit images are supported");
+            }
+        }
+
+        // One tap at a time over the whole row, so the inner loop is a contiguous multiply-add
+        template<typename Accumulator>
+        static void horizontal_pass(const uint8_t* padded, const std::vector<uint32_t>& taps,
+                                    const int channels, const size_t row_bytes, Accumulator* out) {
+            std::fill_n(out, row_bytes, Accumulator{0});
+            for (size_t k = 0; k < taps.size(); ++k) {
+                const auto weight = static_cast<Accumulator>(taps[k]);
+                const uint8_t* source = padded + k * channels;
+                for (size_t i = 0; i < row_bytes; ++i) {
+                    out[i] += static_cast<Accumulator>(weight * source[i]);
+                }
+            }
+        }
+
+        template<typename Accumulator, typename Output>
+        static void separable_band(const ConstImageView& src, const ImageView& dst, const SeparableKernel& kernel,
+                                   const BorderMode border, const uint8_t border_value,
+                                   const int32_t first_row, const int32_t last_row, Output&& output) {
+            const int channels = src.bytes_per_pixel();
+            const auto radius_x = static_cast<int32_t>(kernel.horizontal.size() / 2);
+            const auto radius_y = static_cast<int32_t>(kernel.vertical.size() / 2);
+            const size_t row_bytes = static_cast<size_t>(src.width) * channels;
+
+            std::vector<uint8_t> padded(static_cast<size_t>(src.width + 2 * radius_x) * channels);
+            std::vector<Accumulator> rows(static_cast<size_t>(BAND_HEIGHT + 2 * radius_y) * row_bytes);
+            std::vector<uint32_t> column(row_bytes);
+
+            for (int32_t band = first_row; band < last_row; band += BAND_HEIGHT) {
+                const int32_t band_end = std::min(band + BAND_HEIGHT, last_row);
+                const int32_t band_rows = band_end - band + 2 * radius_y;
+
+                // Row pass over the band plus its vertical halo; the buffer stays cache resident
+                for (int32_t i = 0; i < band_rows; ++i) {
+                    pad_row(src, band - radius_y + i, radius_x, border, border_value, padded.data());
+                    horizontal_pass(padded.data(), kernel.horizontal, channels, row_bytes, rows.data() + i * row_bytes);
+                }
+
+                for (int32_t y = band; y < band_end; ++y) {
+                    std::fill(column.begin(), column.end(), 0);
+                    for (size_t k = 0; k < kernel.vertical.size(); ++k) {
+                        const uint32_t weight = kernel.vertical[k];
+                        const Accumulator* source = rows.data() + (y - band + k) * row_bytes;
+                        for (size_t i = 0; i < row_bytes; ++i) {
+                            column[i] += weight * source[i];
+                        }
+                    }
+                    output(src.row(y), dst.row(y), column.data(), row_bytes);
+                }
+            }
+        }
+
+        template<typename Output>
+        static void separable(const ConstImageView& src, const ImageView& dst, const SeparableKernel& kernel,
+                              const BorderMode border, const uint8_t border_value, Output output) {
+            check_view(src);
+
+            uint64_t horizontal_sum = 0;
+            for (const auto tap : kernel.horizontal) {
+                horizontal_sum += tap;
+            }
+
+            if (kernel.horizontal.size() % 2 == 0 || kernel.vertical.size() % 2 == 0) {
+                throw std::invalid_argument("ConvolutionFilter: separable kernels must have an odd number of taps");
+            }
+
+            parallel::for_each_range(0, src.height, [&](const int64_t first, const int64_t last) {
+                if (horizontal_sum * 255 <= UINT16_MAX) {
+                    separable_band<uint16_t>(src, dst, kernel, border, border_value,
+                                             static_cast<int32_t>(first), static_cast<int32_t>(last), output);
+                } else {
+                    separable_band<uint32_t>(src, dst, kernel, border, border_value,
+                                             static_cast<int32_t>(first), static_cast<int32_t>(last), output);
+                }
+            }, BAND_HEIGHT);
+        }
+
+        static uint64_t sum_of_weights(const SeparableKernel& kernel) {
+            uint64_t horizontal = 0;
+            uint64_t vertical = 0;
+            for (const auto tap : kernel.horizontal) {
+                horizontal += tap;
+            }
+            for (const auto tap : kernel.vertical) {
+                vertical += tap;
+            }
+            return horizontal * vertical;
+        }
+
+    public:
+        // src and dst must not overlap: rows are read by neighbouring bands after they are written
+        static void convolve(const ConstImageView& src, const ImageView& dst, const SeparableKernel& kernel,
+                             const BorderMode border = BorderMode::CLAMP, const uint8_t border_value = 0) {
+            const uint64_t total = sum_of_weights(kernel);
+            if (total == 0 || total * 255 > UINT32_MAX) {
+                throw std::invalid_argument("ConvolutionFilter: separable kernel weights are out of range");
+            }
+
+            separable(src, dst, kernel, border, border_value,
+                [total](const uint8_t*, uint8_t* out, const uint32_t* column, const size_t row_bytes) {
+                    const auto divisor = static_cast<uint32_t>(total);
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        out[i] = static_cast<uint8_t>((column[i] + divisor / 2) / divisor);
+                    }
+                });
+        }
+
+        static void box_blur(const ConstImageView& src, const ImageView& dst, const int32_t radius,
+                             const BorderMode border = BorderMode::CLAMP) {
+            convolve(src, dst, SeparableKernel::box(radius), border);
+        }
+
+        static void gaussian_blur(const ConstImageView& src, const ImageView& dst, const double sigma,
+                                  const BorderMode border = BorderMode::CLAMP) {
+            convolve(src, dst, SeparableKernel::gaussian(sigma), border);
+        }
+
+        // Unsharp mask: out = src + amount * (src - gaussian(src)), fused into the column pass
+        static void unsharp_mask(const ConstImageView& src, const ImageView& dst, const double sigma, const double amount,
+                                 const BorderMode border = BorderMode::CLAMP) {
+            const auto scale = static_cast<int32_t>(std::lround(amount * 256.0));
+
+            separable(src, dst, SeparableKernel::gaussian(sigma), border, 0,
+                [scale](const uint8_t* in, uint8_t* out, const uint32_t* column, const size_t row_bytes) {
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        const auto blurred = static_cast<int32_t>((column[i] + (1u << 15)) >> 16);
+                        const int32_t detail = static_cast<int32_t>(in[i]) - blurred;
+                        const int32_t value = in[i] + ((scale * detail + 128) >> 8);
+                        out[i] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+                    }
+                });
+        }
+
+        // Direct 2D convolution for kernels that do not factor; every channel is filtered independently
+        static void convolve(const ConstImageView& src, const ImageView& dst, const Kernel& kernel,
+                             const BorderMode border = BorderMode::CLAMP, const uint8_t border_value = 0) {
+            check_view(src);
+
+            const int channels = src.bytes_per_pixel();
+            const int32_t radius_x = kernel.get_width() / 2;
+            const int32_t radius_y = kernel.get_height() / 2;
+            const size_t padded_bytes = static_cast<size_t>(src.width + 2 * radius_x) * channels;
+            const size_t row_bytes = static_cast<size_t>(src.width) * channels;
+
+            parallel::for_each_range(0, src.height, [&](const int64_t first, const int64_t last) {
+                std::vector<uint8_t> padded(padded_bytes * kernel.get_height());
+                std::vector<float> sums(row_bytes);
+
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    for (int32_t k = 0; k < kernel.get_height(); ++k) {
+                        pad_row(src, y - radius_y + k, radius_x, border, border_value, padded.data() + k * padded_bytes);
+                    }
+
+                    std::fill(sums.begin(), sums.end(), 0.0f);
+                    for (int32_t ky = 0; ky < kernel.get_height(); ++ky) {
+                        for (int32_t kx = 0; kx < kernel.get_width(); ++kx) {
+                            const float weight = kernel.at(kx, ky);
+                            if (weight == 0.0f) {
+                                continue;
+                            }
+                            const uint8_t* source = padded.data() + ky * padded_bytes + kx * channels;
+                            for (size_t i = 0; i < row_bytes; ++i) {
+                                sums[i] += weight * source[i];
+                            }
+                        }
+                    }
+
+                    uint8_t* out = dst.row(y);
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        out[i] = static_cast<uint8_t>(std::clamp(sums[i] + 0.5f, 0.0f, 255.0f));
+                    }
+                }
+            }, 8);
+        }
+    };
+}
+
+#endif
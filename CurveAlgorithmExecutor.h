@@ -0,0 +1,502 @@
+#ifndef CURVE_ALGORITHM_EXECUTOR_H
+#define CURVE_ALGORITHM_EXECUTOR_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace curve_algorithms {
+
+// Quadratic (three control points) and cubic (four) Bezier curves by adaptive forward differencing.
+// The curve is a polynomial in t stepped by constant differences; whenever a step would move more
+// than one pixel along either axis the step is halved, and whenever twice the step would still stay
+// within one pixel it is doubled, so the curve is walked pixel by pixel with no sampling of its own
+// and an even density however its speed varies. Staircase corners are dropped, leaving a one pixel
+// thin, 8-connected curve.
+//
+// Control points lie on pixel centers, x being the row and y the column as in drawing::Point. The
+// curve runs from the first control point up to, but excluding, the last, so curves and segments
+// chained end to start share no pixel.
+class BezierAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    std::vector<drawing::Point> controls;
+
+    std::vector<drawing::Span> spans;
+
+    // t advances in units of 2^-MAX_DEPTH; steps never get finer than that
+    static constexpr int MAX_DEPTH = 48;
+    static constexpr int CLIP_DEPTH = 8;
+
+    struct Vector {
+        double x;
+        double y;
+
+        Vector operator+(const Vector& other) const { return {x + other.x, y + other.y}; }
+        Vector operator-(const Vector& other) const { return {x - other.x, y - other.y}; }
+        Vector operator*(const double factor) const { return {x * factor, y * factor}; }
+
+        [[nodiscard]] double reach() const { return std::max(std::abs(x), std::abs(y)); }
+    };
+
+    struct Pixel {
+        int32_t row;
+        int32_t column;
+
+        bool operator==(const Pixel&) const = default;
+    };
+
+    // Nearest pixel center; the curve stays within the hull of its control points, which have no
+    // negative coordinates, so rounding by truncation is safe
+    static Pixel pixel_of(const Vector& point) {
+        return {static_cast<int32_t>(point.x + 0.5), static_cast<int32_t>(point.y + 0.5)};
+    }
+
+    // The pixels of the curve in order. The walk only stores them; every CHUNK pixels, repeats
+    // and staircase corners are dropped and the rest are gathered into runs along rows, clipped to
+    // the canvas. Both passes pick where to store the next pixel or run by arithmetic rather than
+    // by branching, since which steps repeat a pixel or end a run is about as predictable as a
+    // coin toss. For every row the columns written so far are remembered as one range; a run that
+    // overlaps it means the curve came back over itself, and the curve's runs are then sorted and
+    // merged at the end so that no pixel is listed twice.
+    class Trail {
+        static constexpr size_t CHUNK = 1024;
+        // Neither equal nor adjacent to each other or to any pixel of the curve
+        static constexpr Pixel NOWHERE {-4, -4};
+        static constexpr Pixel ELSEWHERE {-8, -4};
+
+        const int32_t height;
+        const int32_t width;
+        std::vector<drawing::Span>& out;
+        const size_t first_new;
+
+        Pixel steps[CHUNK];
+        size_t step_count = 0;
+
+        // kept[settled, count) are yet to be gathered; the last one may still turn out a corner
+        // and the one before it decides that, so both are also held as last and before
+        Pixel kept[CHUNK + 2];
+        size_t settled = 0;
+        size_t count = 0;
+        Pixel before = ELSEWHERE;
+        Pixel last = NOWHERE;
+
+        drawing::Span runs[CHUNK + 2];
+        int32_t run_row = NOWHERE.row;
+        int32_t run_begin = 0;
+        int32_t run_end = 0;
+
+        // Columns [begin, end) written on rows first_row + i; begin >= end where none were
+        const int32_t first_row;
+        std::vector<std::pair<int32_t, int32_t>> written;
+
+        static bool adjacent(const Pixel& a, const Pixel& b) {
+            return std::max(std::abs(a.row - b.row), std::abs(a.column - b.column)) == 1;
+        }
+
+        // A pixel touching the one before the last makes the last a corner, which it replaces
+        void drop_repeats_and_corners() {
+            Pixel previous = before;
+            Pixel latest = last;
+            size_t next = count;
+            for (size_t i = 0; i < step_count; ++i) {
+                const Pixel& pixel = steps[i];
+                const bool fresh = pixel != latest;
+                const bool corner = adjacent(previous, pixel);
+                const size_t index = fresh ? next - corner : next;
+                kept[index] = pixel;
+                next = index + fresh;
+                previous = fresh && !corner ? latest : previous;
+                latest = fresh ? pixel : latest;
+            }
+            before = previous;
+            last = latest;
+            count = next;
+            step_count = 0;
+        }
+
+        // Joins kept[settled, end) into the runs and writes out the finished ones
+        void gather(const size_t end) {
+            int32_t row = run_row;
+            int32_t begin = run_begin;
+            int32_t stop = run_end;
+            size_t finished = 0;
+            for (size_t i = settled; i < end; ++i) {
+                const Pixel& pixel = kept[i];
+                const bool same_row = pixel.row == row;
+                const bool right = same_row && pixel.column == stop;
+                const bool left = same_row && pixel.column + 1 == begin;
+                const bool fresh = !(right || left);
+
+                const int32_t clipped_begin = std::max(begin, 0);
+                const int32_t clipped_end = std::min(stop, width);
+                runs[finished] = {row, clipped_begin, clipped_end};
+                finished += fresh && row >= 0 && row < height && clipped_begin < clipped_end;
+
+                row = pixel.row;
+                begin = fresh ? pixel.column : begin - left;
+                stop = fresh ? pixel.column + 1 : stop + right;
+            }
+            run_row = row;
+            run_begin = begin;
+            run_end = stop;
+            out.insert(out.end(), runs, runs + finished);
+            settled = end;
+        }
+
+        void flush_steps() {
+            drop_repeats_and_corners();
+            if (count < 2) {
+                return;
+            }
+            gather(count - 1);
+            kept[0] = kept[count - 2];
+            kept[1] = kept[count - 1];
+            settled = 1;
+            count = 2;
+        }
+
+    public:
+        // The curve stays within rows [first_row, last_row] wherever it is on the canvas
+        Trail(const int32_t height, const int32_t width, std::vector<drawing::Span>& out,
+              const int32_t first_row, const int32_t last_row) :
+            height(height), width(width), out(out), first_new(out.size()),
+            first_row(first_row), written(static_cast<size_t>(std::max(last_row - first_row + 1, 0))) {}
+
+        void extend(const Pixel& pixel) {
+            steps[step_count++] = pixel;
+            if (step_count == CHUNK) {
+                flush_steps();
+            }
+        }
+
+        // Writes out what is left, leaving off the trailing pixels that are the excluded endpoint
+        void finish(const Pixel& excluded) {
+            drop_repeats_and_corners();
+            while (count > settled && kept[count - 1] == excluded) {
+                --count;
+            }
+            kept[count] = NOWHERE;
+            gather(count + 1);
+
+            bool crossed = false;
+            for (size_t i = first_new; i < out.size(); ++i) {
+                const drawing::Span& run = out[i];
+                auto& [begin, end] = written[run.row - first_row];
+                if (begin < end) {
+                    crossed = crossed || (run.begin < end && begin < run.end);
+                    begin = std::min(begin, run.begin);
+                    end = std::max(end, run.end);
+                } else {
+                    begin = run.begin;
+                    end = run.end;
+                }
+            }
+            if (crossed) {
+                merge_spans(out, first_new);
+            }
+        }
+    };
+
+    // Walks the cubic with control points p, feeding every pixel it passes to the trail
+    static void walk(const Vector (&p)[4], Trail& trail) {
+        // P(t) = p0 + a t + b t^2 + c t^3
+        const Vector a = (p[1] - p[0]) * 3;
+        const Vector b = (p[0] - p[1] * 2 + p[2]) * 3;
+        const Vector c = p[3] - p[0] + (p[1] - p[2]) * 3;
+
+        // Forward differences for a step of 1
+        Vector d1 = a + b + c;
+        Vector d2 = b * 2 + c * 6;
+        Vector d3 = c * 6;
+
+        constexpr uint64_t END = uint64_t {1} << MAX_DEPTH;
+        int depth = 0;
+        uint64_t t = 0;
+        Vector position = p[0];
+        trail.extend(pixel_of(position));
+
+        while (t < END) {
+            // Halving: d3' = d3 / 8, d2' = d2 / 4 - d3', d1' = (d1 - d2') / 2
+            while (d1.reach() > 1 && depth < MAX_DEPTH) {
+                d3 = d3 * 0.125;
+                d2 = d2 * 0.25 - d3;
+                d1 = (d1 - d2) * 0.5;
+                ++depth;
+            }
+            // Doubling: d1' = 2 d1 + d2, d2' = 4 d2 + 4 d3, d3' = 8 d3, allowed where t is a
+            // multiple of the doubled step
+            while (depth > 0 && d1.reach() < 0.5 && (t & ((END >> (depth - 1)) - 1)) == 0 && (d1 * 2 + d2).reach() <= 1) {
+                d1 = d1 * 2 + d2;
+                d2 = (d2 + d3) * 4;
+                d3 = d3 * 8;
+                --depth;
+            }
+
+            position = position + d1;
+            d1 = d1 + d2;
+            d2 = d2 + d3;
+            t += END >> depth;
+            trail.extend(pixel_of(t == END ? p[3] : position));
+        }
+    }
+
+    // Skips the parts of the curve that miss the canvas: a cubic whose control points straddle
+    // the canvas border is halved by de Casteljau's construction, down to CLIP_DEPTH levels, and
+    // halves whose control hull lies off the canvas are dropped without being walked
+    static void clip(const Vector (&p)[4], const int level, const int32_t height, const int32_t width, Trail& trail) {
+        double top = p[0].x;
+        double bottom = p[0].x;
+        double left = p[0].y;
+        double right = p[0].y;
+        for (const Vector& point : p) {
+            top = std::min(top, point.x);
+            bottom = std::max(bottom, point.x);
+            left = std::min(left, point.y);
+            right = std::max(right, point.y);
+        }
+        // Pixel centers round from up to half a pixel away
+        const double last_row = height - 0.5;
+        const double last_column = width - 0.5;
+        if (bottom < -0.5 || top >= last_row || right < -0.5 || left >= last_column) {
+            return;
+        }
+        if (level == CLIP_DEPTH || (top >= -0.5 && bottom < last_row && left >= -0.5 && right < last_column)) {
+            walk(p, trail);
+            return;
+        }
+
+        const Vector p01 = (p[0] + p[1]) * 0.5;
+        const Vector p12 = (p[1] + p[2]) * 0.5;
+        const Vector p23 = (p[2] + p[3]) * 0.5;
+        const Vector p012 = (p01 + p12) * 0.5;
+        const Vector p123 = (p12 + p23) * 0.5;
+        const Vector middle = (p012 + p123) * 0.5;
+        const Vector first[4] {p[0], p01, p012, middle};
+        const Vector second[4] {middle, p123, p23, p[3]};
+        clip(first, level + 1, height, width, trail);
+        clip(second, level + 1, height, width, trail);
+    }
+
+public:
+    BezierAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        std::vector<drawing::Point> controls
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        controls(std::move(controls)) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        spans.clear();
+        append_spans(controls, drawer->get_canvas_height(), drawer->get_canvas_width(), spans);
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the pixels of the curve that fall on a height x width canvas, as runs in the order
+    // the curve passes them; those of a curve that comes back over itself are sorted and merged
+    // instead, so no pixel is listed twice
+    static void append_spans(
+        const std::span<const drawing::Point> controls,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        if (controls.size() != 3 && controls.size() != 4) {
+            throw std::invalid_argument("A Bezier curve has three or four control points");
+        }
+
+        Vector p[4] {};
+        for (size_t i = 0; i < controls.size(); ++i) {
+            if (controls[i].x >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT ||
+                controls[i].y >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT) {
+                throw std::out_of_range("Control point coordinates must stay within 2^30");
+            }
+            p[i] = {static_cast<double>(controls[i].x), static_cast<double>(controls[i].y)};
+        }
+        // A quadratic is the cubic with its inner control points two thirds of the way to the middle one
+        if (controls.size() == 3) {
+            p[3] = p[2];
+            p[2] = p[3] + (p[1] - p[3]) * (2.0 / 3);
+            p[1] = p[0] + (p[1] - p[0]) * (2.0 / 3);
+        }
+
+        double top = p[0].x;
+        double bottom = p[0].x;
+        for (const Vector& point : p) {
+            top = std::min(top, point.x);
+            bottom = std::max(bottom, point.x);
+        }
+        const auto first_row = static_cast<int32_t>(std::min<double>(top + 0.5, height));
+        const auto last_row = static_cast<int32_t>(std::min<double>(bottom + 0.5, height - 1));
+
+        Trail trail(height, width, out, first_row, last_row);
+        clip(p, 0, height, width, trail);
+        trail.finish(pixel_of(p[3]));
+    }
+};
+
+// Circular arc by the midpoint stepping of CircleBresenhamAlgorithmExecutor: one octant is walked
+// with integer decisions only and each of its eight mirrors is kept where it lies within the arc's
+// angular range, so an arc is exactly the matching part of the full circle.
+//
+// Angles are in radians, 0 pointing along the columns and growing counterclockwise as the image is
+// viewed, i.e. towards smaller rows. The arc starts at start_angle and turns by sweep_angle,
+// clockwise when that is negative; both ends are included.
+class ArcAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    uint32_t cx;
+    uint32_t cy;
+    uint32_t r;
+    double start_angle;
+    double sweep_angle;
+
+    std::vector<drawing::Span> spans;
+
+public:
+    ArcAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        const uint32_t cx,
+        const uint32_t cy,
+        const uint32_t r,
+        const double start_angle,
+        const double sweep_angle
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        cx(cx),
+        cy(cy),
+        r(r),
+        start_angle(start_angle),
+        sweep_angle(sweep_angle) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        spans.clear();
+        append_spans(static_cast<int32_t>(cx), static_cast<int32_t>(cy), r, start_angle, sweep_angle,
+                     drawer->get_canvas_height(), drawer->get_canvas_width(), spans);
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the pixels of the arc around row cx, column cy that fall on a height x width canvas
+    // as disjoint spans, sorted by row and column
+    static void append_spans(
+        const int32_t cx,
+        const int32_t cy,
+        const uint32_t r,
+        double start_angle,
+        double sweep_angle,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        constexpr int64_t RADIUS_LIMIT = int64_t {1} << 24;
+        if (r >= RADIUS_LIMIT) {
+            throw std::out_of_range("Arc radius must stay below 2^24");
+        }
+        if (!std::isfinite(start_angle) || !std::isfinite(sweep_angle)) {
+            throw std::invalid_argument("Arc angles must be finite");
+        }
+        const int64_t reach = r;
+        if (cx + reach < 0 || cx - reach >= height || cy + reach < 0 || cy - reach >= width) {
+            return;
+        }
+
+        if (sweep_angle < 0) {
+            start_angle += sweep_angle;
+            sweep_angle = -sweep_angle;
+        }
+        const bool full = sweep_angle >= 2 * std::numbers::pi;
+
+        // Offsets are taken as vectors (column, -row); a pixel is on the arc when its direction lies
+        // between the start and end directions, tested by cross products against them and by
+        // a dot product against the bisector of the smaller of the arc and its complement. Sines
+        // and cosines of exact axis angles are off by an ulp (cos(pi / 2) is about 6e-17), so the
+        // tests allow a slack far below any pixel's distance from a direction, keeping end pixels
+        // on the axes and diagonals.
+        const double end_angle = start_angle + sweep_angle;
+        const double s_x = std::cos(start_angle);
+        const double s_y = std::sin(start_angle);
+        const double e_x = std::cos(end_angle);
+        const double e_y = std::sin(end_angle);
+        const bool major = sweep_angle > std::numbers::pi;
+        const double middle = start_angle + sweep_angle / 2 + (major ? std::numbers::pi : 0);
+        const double m_x = std::cos(middle);
+        const double m_y = std::sin(middle);
+        const double slack = 1e-9 * (static_cast<double>(r) + 1);
+        const auto on_arc = [&](const int64_t u, const int64_t v) {
+            if (full) {
+                return true;
+            }
+            const auto p_x = static_cast<double>(v);
+            const auto p_y = static_cast<double>(-u);
+            if (!major) {
+                return s_x * p_y - s_y * p_x >= -slack && p_x * e_y - p_y * e_x >= -slack &&
+                       p_x * m_x + p_y * m_y >= -slack;
+            }
+            // Outside only when strictly inside the complement, which runs from the end to the start
+            return !(e_x * p_y - e_y * p_x > slack && p_x * s_y - p_y * s_x > slack && p_x * m_x + p_y * m_y > slack);
+        };
+
+        const size_t first_new = out.size();
+        const auto put = [&](const int64_t u, const int64_t v) {
+            const int64_t row = cx + u;
+            const int64_t column = cy + v;
+            if (row >= 0 && row < height && column >= 0 && column < width && on_arc(u, v)) {
+                out.push_back({static_cast<int32_t>(row), static_cast<int32_t>(column), static_cast<int32_t>(column) + 1});
+            }
+        };
+
+        int64_t x = 0;
+        int64_t y = r;
+        int64_t sd = 2 - 2 * static_cast<int64_t>(r);
+        while (y >= x) {
+            put(x, y);
+            put(-x, y);
+            put(x, -y);
+            put(-x, -y);
+            put(y, x);
+            put(-y, x);
+            put(y, -x);
+            put(-y, -x);
+
+            const int64_t err = 2 * (sd + y) - 1;
+            if (sd < 0 && err <= 0) {
+                sd += 2 * ++x + 1;
+                continue;
+            }
+            if (sd > 0 && err >= 0) {
+                sd -= 2 * --y + 1;
+                continue;
+            }
+            sd += 2 * (++x - --y);
+        }
+
+        // Mirrors coincide on the axes and the diagonals
+        merge_spans(out, first_new);
+    }
+};
+
+}
+
+#endif
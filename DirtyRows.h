@@ -0,0 +1,59 @@
+#ifndef DIRTY_ROWS_H
+#define DIRTY_ROWS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace bmp {
+
+    // Rows of an image that differ from the file it was read from or last written to. Each row
+    // has a flag byte of its own, a separate memory location, so threads drawing disjoint rows
+    // may mark them concurrently.
+    // Operations that rewrite every pixel or change the layout mark the whole image instead.
+    class DirtyRows {
+        std::vector<uint8_t> rows;
+        bool whole {true};
+
+    public:
+        // Every one of height rows clean
+        void reset(const int32_t height) {
+            rows.assign(static_cast<size_t>(std::max(height, 0)), 0);
+            whole = false;
+        }
+
+        void mark_all() {
+            whole = true;
+        }
+
+        // Rows [first, last), clipped to the image
+        void mark(const int32_t first, const int32_t last) {
+            const int32_t end = std::min(last, static_cast<int32_t>(rows.size()));
+            for (int32_t row = std::max(first, 0); row < end; ++row) {
+                rows[row] = 1;
+            }
+        }
+
+        [[nodiscard]] bool all() const {
+            return whole;
+        }
+
+        // Calls operation(first, last) for every maximal run [first, last) of dirty rows, top to bottom
+        template<typename Operation>
+        void for_each_run(Operation&& operation) const {
+            const auto height = static_cast<int32_t>(rows.size());
+            for (int32_t row = 0; row < height; ++row) {
+                if (!rows[row]) {
+                    continue;
+                }
+                const int32_t first = row;
+                while (row < height && rows[row]) {
+                    ++row;
+                }
+                operation(first, row);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,277 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include "Drawer.h"
+#include "EllipseAlgorithmExecutor.h"
+#include "FillingAlgorithmExecutor.h"
+#include "Parallel.h"
+#include "PolygonAlgorithmExecutor.h"
+#include "WuAlgorithmExecutor.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace drawing {
+
+// Records primitives for one canvas and draws them all on flush. Primitives are binned by the
+// rows they touch into bands of BAND_HEIGHT full-width rows. On a BmpDrawer the bands are split
+// among threads, each thread rasterizing only its own bands' rows, so no two threads ever write
+// the same pixel; any other Drawer gets every band from the calling thread. Every primitive
+// clips itself to a band by being rasterized on a canvas shifted to the band.
+//
+// All ink is black: span stores and coverage blends commute, so a band may draw its spans and
+// then its blends. A seed fill reads the canvas and therefore splits the list: everything
+// recorded before it is drawn first, then the fill runs on the whole canvas.
+class DisplayList {
+public:
+    static constexpr int32_t BAND_HEIGHT = 32;
+
+private:
+    struct Line {
+        int32_t i0, j0, i1, j1;
+        bool antialiased;
+
+        // Anti-aliased pixels may reach one row past the endpoints
+        [[nodiscard]] std::pair<int64_t, int64_t> rows() const {
+            return {std::min(i0, i1) - 1, std::max(i0, i1) + 1};
+        }
+
+        void rasterize(const int32_t first, const int32_t last, const int32_t width,
+                       std::vector<Span>& spans, std::vector<Coverage>& pixels) const {
+            if (antialiased) {
+                curve_algorithms::WuLineAlgorithmExecutor::append_coverage(
+                    i0 - first, j0, i1 - first, j1, last - first, width, pixels);
+            } else {
+                curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                    i0 - first, j0, i1 - first, j1, last - first, width, spans);
+            }
+        }
+    };
+
+    struct Circle {
+        int32_t cx, cy;
+        uint32_t r;
+        bool antialiased;
+
+        [[nodiscard]] std::pair<int64_t, int64_t> rows() const {
+            return {static_cast<int64_t>(cx) - r - 1, static_cast<int64_t>(cx) + r + 1};
+        }
+
+        void rasterize(const int32_t first, const int32_t last, const int32_t width,
+                       std::vector<Span>& spans, std::vector<Coverage>& pixels) const {
+            if (antialiased) {
+                curve_algorithms::WuCircleAlgorithmExecutor::append_coverage(cx - first, cy, r, last - first, width, pixels);
+            } else {
+                curve_algorithms::EllipseAlgorithmExecutor::append_spans(cx - first, cy, r, r, 0.0, false,
+                                                                         last - first, width, spans);
+            }
+        }
+    };
+
+    struct Ellipse {
+        int32_t cx, cy;
+        uint32_t row_radius, column_radius;
+        double angle;
+        bool filled;
+
+        [[nodiscard]] std::pair<int64_t, int64_t> rows() const {
+            const int64_t reach = std::max(row_radius, column_radius);
+            return {cx - reach, cx + reach};
+        }
+
+        void rasterize(const int32_t first, const int32_t last, const int32_t width,
+                       std::vector<Span>& spans, std::vector<Coverage>&) const {
+            curve_algorithms::EllipseAlgorithmExecutor::append_spans(cx - first, cy, row_radius, column_radius, angle,
+                                                                     filled, last - first, width, spans);
+        }
+    };
+
+    struct Polygon {
+        std::vector<Point> vertices;
+        curve_algorithms::FillRule rule;
+
+        [[nodiscard]] std::pair<int64_t, int64_t> rows() const {
+            const auto [top, bottom] = std::minmax_element(vertices.begin(), vertices.end(),
+                [](const Point& a, const Point& b) { return a.x < b.x; });
+            return {top->x, bottom->x};
+        }
+
+        // Already clipped to rows [first, last) of the real canvas, so its spans are not shifted.
+        // The edge table is built once per flush and shared by every band the polygon touches.
+        void rasterize(const curve_algorithms::PolygonAlgorithmExecutor::EdgeTable& edges,
+                       const int32_t first, const int32_t last, const int32_t width,
+                       std::vector<Span>& spans) const {
+            curve_algorithms::PolygonAlgorithmExecutor::append_rows(edges, rule, first, last, width, spans);
+        }
+    };
+
+    struct Fill {
+        int32_t row, column;
+    };
+
+    using Primitive = std::variant<Line, Circle, Ellipse, Polygon, Fill>;
+
+    Drawer& drawer;
+    std::vector<Primitive> primitives;
+
+    // Draws primitives [begin, end), none of which is a fill
+    void draw_bands(const size_t begin, const size_t end) {
+        const int32_t height = drawer.get_canvas_height();
+        const int32_t width = drawer.get_canvas_width();
+        const int64_t bands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+        if (begin == end || bands == 0) {
+            return;
+        }
+
+        // Bins keep the recording order, so a band sees its primitives in the order they were made
+        std::vector<std::vector<uint32_t>> bins(bands);
+        std::vector<curve_algorithms::PolygonAlgorithmExecutor::EdgeTable> edge_tables(end - begin);
+        for (size_t index = begin; index < end; ++index) {
+            const auto [top, bottom] = std::visit([](const auto& primitive) -> std::pair<int64_t, int64_t> {
+                if constexpr (std::is_same_v<std::decay_t<decltype(primitive)>, Fill>) {
+                    return {0, -1};
+                } else {
+                    return primitive.rows();
+                }
+            }, primitives[index]);
+            if (bottom < 0 || top >= height || top > bottom) {
+                continue;
+            }
+            if (const auto* polygon = std::get_if<Polygon>(&primitives[index])) {
+                edge_tables[index - begin] = curve_algorithms::PolygonAlgorithmExecutor::make_edge_table(polygon->vertices);
+            }
+            const int64_t first_band = std::max<int64_t>(top, 0) / BAND_HEIGHT;
+            const int64_t last_band = std::min<int64_t>(bottom, height - 1) / BAND_HEIGHT;
+            for (int64_t band = first_band; band <= last_band; ++band) {
+                bins[band].push_back(static_cast<uint32_t>(index));
+            }
+        }
+
+        const auto draw_range = [&](const int64_t first_band, const int64_t last_band) {
+            std::vector<Span> spans;
+            std::vector<Coverage> pixels;
+            for (int64_t band = first_band; band < last_band; ++band) {
+                const auto first = static_cast<int32_t>(band * BAND_HEIGHT);
+                const auto last = std::min(first + BAND_HEIGHT, height);
+                spans.clear();
+                pixels.clear();
+
+                for (const uint32_t index : bins[band]) {
+                    if (const auto* polygon = std::get_if<Polygon>(&primitives[index])) {
+                        polygon->rasterize(edge_tables[index - begin], first, last, width, spans);
+                        continue;
+                    }
+                    const size_t shifted_spans = spans.size();
+                    const size_t shifted_pixels = pixels.size();
+                    std::visit([&](const auto& primitive) {
+                        using Type = std::decay_t<decltype(primitive)>;
+                        if constexpr (!std::is_same_v<Type, Fill> && !std::is_same_v<Type, Polygon>) {
+                            primitive.rasterize(first, last, width, spans, pixels);
+                        }
+                    }, primitives[index]);
+
+                    for (size_t i = shifted_spans; i < spans.size(); ++i) {
+                        spans[i].row += first;
+                    }
+                    for (size_t i = shifted_pixels; i < pixels.size(); ++i) {
+                        pixels[i].row += first;
+                    }
+                }
+
+                drawer.draw(spans);
+                drawer.draw(pixels);
+            }
+        };
+
+        // Only a BmpDrawer promises that draws of disjoint rows may run concurrently
+        if (const auto bmp_drawer = dynamic_cast<BmpDrawer*>(&drawer)) {
+            bmp_drawer->synchronize();
+            parallel::for_each_range(0, bands, draw_range);
+        } else {
+            draw_range(0, bands);
+        }
+    }
+
+    void fill_region(const Fill& fill) {
+        const auto bmp_drawer = dynamic_cast<BmpDrawer*>(&drawer);
+        if (!bmp_drawer) {
+            throw std::runtime_error("Unknown way to define borders: unknown file type");
+        }
+        bmp_drawer->synchronize();
+        const auto spans = FillingAlgorithmExecutor::fill(std::as_const(*bmp_drawer).get_handler().view(),
+                                                          fill.row, fill.column);
+        drawer.draw(spans);
+    }
+
+public:
+    explicit DisplayList(Drawer& drawer) : drawer(drawer) {}
+
+    void line(const int32_t i0, const int32_t j0, const int32_t i1, const int32_t j1) {
+        primitives.emplace_back(Line {i0, j0, i1, j1, false});
+    }
+
+    void antialiased_line(const int32_t i0, const int32_t j0, const int32_t i1, const int32_t j1) {
+        primitives.emplace_back(Line {i0, j0, i1, j1, true});
+    }
+
+    void circle(const int32_t cx, const int32_t cy, const uint32_t r) {
+        primitives.emplace_back(Circle {cx, cy, r, false});
+    }
+
+    void antialiased_circle(const int32_t cx, const int32_t cy, const uint32_t r) {
+        primitives.emplace_back(Circle {cx, cy, r, true});
+    }
+
+    void ellipse(const int32_t cx, const int32_t cy, const uint32_t row_radius, const uint32_t column_radius,
+                 const double angle = 0.0, const bool filled = true) {
+        primitives.emplace_back(Ellipse {cx, cy, row_radius, column_radius, angle, filled});
+    }
+
+    void polygon(std::vector<Point> vertices,
+                 const curve_algorithms::FillRule rule = curve_algorithms::FillRule::NONZERO) {
+        if (vertices.empty()) {
+            return;
+        }
+        primitives.emplace_back(Polygon {std::move(vertices), rule});
+    }
+
+    // Seed fill of the region around (row, column) as the canvas looks once everything recorded
+    // before it has been drawn
+    void fill(const int32_t row, const int32_t column) {
+        primitives.emplace_back(Fill {row, column});
+    }
+
+    [[nodiscard]] size_t size() const {
+        return primitives.size();
+    }
+
+    // Draws everything recorded so far onto the canvas and empties the list
+    void flush() {
+        size_t begin = 0;
+        for (size_t index = 0; index < primitives.size(); ++index) {
+            if (const auto* fill = std::get_if<Fill>(&primitives[index])) {
+                draw_bands(begin, index);
+                fill_region(*fill);
+                begin = index + 1;
+            }
+        }
+        draw_bands(begin, primitives.size());
+        primitives.clear();
+    }
+
+    void save(const std::string& filename) {
+        flush();
+        drawer.save(filename);
+    }
+};
+
+}
+
+#endif
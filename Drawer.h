@@ -1,23 +1,42 @@
 #ifndef DRAWER_H
 #define DRAWER_H
 
+#include <algorithm>
+#include <cstring>
+#include <span>
 #include <vector>
 #include "Bmp.h"
+#include "Canvas.h"
 #include "ImageType.h"
 #include "Point.h"
 
 namespace drawing {
 
+// Implementations need not be thread-safe: unless an implementation says otherwise, its methods
+// must not be called from several threads at once.
 class Drawer {
 public:
     virtual ~Drawer() = default;
-    virtual void draw(std::vector<Point> points) = 0;
+    virtual void draw(std::span<const Point> points) = 0;
+    virtual void draw(std::span<const Span> spans) = 0;
+    virtual void draw(std::span<const Coverage> pixels) = 0;
     virtual void draw(const Point& point) = 0;
     virtual void save(const std::string& filename) const = 0;
+    // Color of everything drawn from now on, encoded as for Canvas
+    virtual void set_ink(uint32_t value) = 0;
+    [[nodiscard]] virtual int32_t get_canvas_width() const = 0;
+    [[nodiscard]] virtual int32_t get_canvas_height() const = 0;
 };
 
+// Type-erased edge over Canvas: the pixel format is looked up once per batch, then every pixel
+// of the batch goes through the Canvas specialized for it. The rows drawn on are reported to the
+// handler, so saving back to the file the canvas came from writes only those rows.
+//
+// After synchronize, draw calls for spans and coverage on disjoint rows may run on different
+// threads at once, as long as nothing else touches the handler meanwhile.
 class BmpDrawer final : public Drawer {
     bmp::BmpHandler* handler;
+    uint32_t ink {0};
 
 public:
     BmpDrawer() {
@@ -34,16 +53,85 @@ public:
         delete handler;
     }
 
-    void draw(std::vector<Point> points) override {}
+    // Points off the canvas are dropped, the rest are sorted into rows and merged into runs
+    void draw(const std::span<const Point> points) override {
+        const bmp::ConstImageView canvas = handler->tracked_view();
+
+        std::vector<Point> sorted;
+        sorted.reserve(points.size());
+        for (const Point& point : points) {
+            if (point.x < static_cast<uint32_t>(canvas.height) && point.y < static_cast<uint32_t>(canvas.width)) {
+                sorted.push_back(point);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<Span> spans;
+        for (const Point& point : sorted) {
+            const auto row = static_cast<int32_t>(point.x);
+            const auto column = static_cast<int32_t>(point.y);
+            if (!spans.empty() && spans.back().row == row && spans.back().end >= column) {
+                spans.back().end = std::max(spans.back().end, column + 1);
+            } else {
+                spans.push_back({row, column, column + 1});
+            }
+        }
+
+        draw(spans);
+    }
+
+    // Every span is clipped to the canvas and written as one contiguous store
+    void draw(const std::span<const Span> spans) override {
+        with_canvas(handler->tracked_view(), [&](const auto& canvas) {
+            canvas.fill(spans, ink);
+        });
+        for (const Span& span : spans) {
+            if (span.begin < span.end) {
+                handler->mark_dirty(span.row, span.row + 1);
+            }
+        }
+    }
+
+    // Blends the ink into each pixel by its coverage, see Canvas::blend. A pixel listed twice is
+    // blended twice.
+    void draw(const std::span<const Coverage> pixels) override {
+        with_canvas(handler->tracked_view(), [&](const auto& canvas) {
+            canvas.blend(pixels, ink);
+        });
+        for (const Coverage& pixel : pixels) {
+            handler->mark_dirty(pixel.row, pixel.row + 1);
+        }
+    }
+
+    // Merges a planar canvas back into interleaved bytes, so that draws need not do it. Call on
+    // one thread before drawing from several.
+    void synchronize() {
+        handler->to_interleaved();
+    }
 
     void draw(const Point& point) override {
-        handler->draw_pixel_black(point.x * 3 * static_cast<uint32_t>(handler->get_image_width()) + point.y * 3);
+        const Span span {static_cast<int32_t>(point.x), static_cast<int32_t>(point.y), static_cast<int32_t>(point.y) + 1};
+        draw(std::span(&span, 1));
     }
 
     void save(const std::string& filename) const override {
         handler->write(filename);
     }
 
+    void set_ink(const uint32_t value) override {
+        ink = value;
+    }
+
+    [[nodiscard]] int32_t get_canvas_width() const override {
+        return handler->get_image_width();
+    }
+
+    [[nodiscard]] int32_t get_canvas_height() const override {
+        return std::abs(handler->get_image_height());
+    }
+
+    [[nodiscard]] bmp::BmpHandler& get_handler() { return *handler; }
+
     [[nodiscard]] const bmp::BmpHandler& get_handler() const { return *handler; }
 };
 
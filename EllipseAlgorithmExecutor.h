@@ -0,0 +1,260 @@
+#ifndef ELLIPSE_ALGORITHM_EXECUTOR_H
+#define ELLIPSE_ALGORITHM_EXECUTOR_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace curve_algorithms {
+
+// Circles and ellipses rasterized straight into one span per row: the shape is first described by
+// the half-width of every row around the center, filled shapes write that row span as is and
+// outlines keep only the pixels of a row that are not covered on all four sides.
+class EllipseAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    int32_t center_row;
+    int32_t center_column;
+    uint32_t row_radius;
+    uint32_t column_radius;
+    double angle;
+    bool filled;
+
+    std::vector<drawing::Span> spans;
+
+    // Same stepping as CircleBresenhamAlgorithmExecutor, so a disk covers exactly its outline
+    static std::vector<int64_t> circle_half_widths(const int64_t r) {
+        std::vector<int64_t> half_widths(r + 1, 0);
+        int64_t x = 0;
+        int64_t y = r;
+        int64_t sd = 2 - 2 * r;
+
+        while (y >= x) {
+            half_widths[x] = std::max(half_widths[x], y);
+            half_widths[y] = std::max(half_widths[y], x);
+
+            const int64_t err = 2 * (sd + y) - 1;
+            if (sd < 0 && err <= 0) {
+                sd += 2 * ++x + 1;
+                continue;
+            }
+            if (sd > 0 && err >= 0) {
+                sd -= 2 * --y + 1;
+                continue;
+            }
+            sd += 2 * (++x - --y);
+        }
+        return half_widths;
+    }
+
+    // Midpoint ellipse, one row at a time: the half-width of row offset y is the largest x whose
+    // inner pixel edge x - 1/2 is inside, i.e. b^2 (2x - 1)^2 + 4 a^2 y^2 <= 4 a^2 b^2. The decision
+    // variable is updated by differences only, and x never shrinks while y walks towards the center.
+    // a is the column radius, b the row radius; the result is indexed by the row offset
+    static std::vector<int64_t> ellipse_half_widths(const int64_t a, const int64_t b) {
+        std::vector<int64_t> half_widths(b + 1, 0);
+        if (a == 0 || b == 0) {
+            std::fill(half_widths.begin(), half_widths.end(), a);
+            return half_widths;
+        }
+
+        const int64_t a2 = a * a;
+        const int64_t b2 = b * b;
+        int64_t x = 0;
+        // Decision for the next pixel, x + 1, on row b
+        int64_t d = b2;
+
+        for (int64_t y = b; y >= 0; --y) {
+            while (d <= 0) {
+                ++x;
+                d += 8 * b2 * x;
+            }
+            half_widths[y] = x;
+            d += 4 * a2 * (1 - 2 * y);
+        }
+        return half_widths;
+    }
+
+    // Rows [first, last] of the filled shape as spans, empty where the shape misses the row
+    static std::vector<drawing::Span> symmetric_rows(const int64_t center_row, const int64_t center_column,
+                                                     const std::vector<int64_t>& half_widths,
+                                                     const int64_t first, const int64_t last) {
+        std::vector<drawing::Span> rows;
+        rows.reserve(std::max<int64_t>(last - first + 1, 0));
+        const auto radius = static_cast<int64_t>(half_widths.size()) - 1;
+
+        for (int64_t row = first; row <= last; ++row) {
+            const int64_t offset = std::abs(row - center_row);
+            if (offset > radius) {
+                rows.push_back({static_cast<int32_t>(row), 0, 0});
+                continue;
+            }
+            const int64_t half_width = half_widths[offset];
+            rows.push_back({static_cast<int32_t>(row), static_cast<int32_t>(center_column - half_width),
+                            static_cast<int32_t>(center_column + half_width + 1)});
+        }
+        return rows;
+    }
+
+    // Rotated ellipse: u = X cos + Y sin, v = Y cos - X sin, inside when (u / a)^2 + (v / b)^2 <= 1.
+    // Each row solves the quadratic in X and takes the columns whose centers lie inside.
+    static std::vector<drawing::Span> rotated_rows(const int64_t center_row, const int64_t center_column,
+                                                   const double a, const double b, const double angle,
+                                                   const int64_t first, const int64_t last) {
+        const double c = std::cos(angle);
+        const double s = std::sin(angle);
+        const double xx = c * c / (a * a) + s * s / (b * b);
+        const double xy = 2.0 * s * c * (1.0 / (a * a) - 1.0 / (b * b));
+        const double yy = s * s / (a * a) + c * c / (b * b);
+
+        std::vector<drawing::Span> rows;
+        rows.reserve(std::max<int64_t>(last - first + 1, 0));
+
+        for (int64_t row = first; row <= last; ++row) {
+            const auto y = static_cast<double>(row - center_row);
+            const double discriminant = xy * xy * y * y - 4.0 * xx * (yy * y * y - 1.0);
+            if (discriminant < 0.0) {
+                rows.push_back({static_cast<int32_t>(row), 0, 0});
+                continue;
+            }
+
+            const double root = std::sqrt(discriminant);
+            const double low = (-xy * y - root) / (2.0 * xx);
+            const double high = (-xy * y + root) / (2.0 * xx);
+            auto begin = static_cast<int64_t>(std::ceil(low));
+            auto end = static_cast<int64_t>(std::floor(high)) + 1;
+            if (begin >= end) {
+                // A sliver thinner than a pixel still gets its nearest pixel, keeping the shape connected
+                begin = std::lround((low + high) / 2.0);
+                end = begin + 1;
+            }
+            rows.push_back({static_cast<int32_t>(row), static_cast<int32_t>(center_column + begin),
+                            static_cast<int32_t>(center_column + end)});
+        }
+        return rows;
+    }
+
+    static bool is_empty(const drawing::Span& span) {
+        return span.begin >= span.end;
+    }
+
+    // A pixel belongs to the outline unless both horizontal neighbours are on its row span and
+    // it is covered by the spans above and below; what is left is at most two runs per row
+    static void append_outline(const std::vector<drawing::Span>& rows, const size_t index, std::vector<drawing::Span>& out) {
+        const drawing::Span& row = rows[index];
+        const drawing::Span* above = index > 0 ? &rows[index - 1] : nullptr;
+        const drawing::Span* below = index + 1 < rows.size() ? &rows[index + 1] : nullptr;
+
+        if (!above || !below || is_empty(*above) || is_empty(*below)) {
+            out.push_back(row);
+            return;
+        }
+
+        const int32_t inner_begin = std::max({row.begin + 1, above->begin, below->begin});
+        const int32_t inner_end = std::min({row.end - 1, above->end, below->end});
+        if (inner_begin >= inner_end) {
+            out.push_back(row);
+            return;
+        }
+
+        out.push_back({row.row, row.begin, inner_begin});
+        out.push_back({row.row, inner_end, row.end});
+    }
+
+public:
+    EllipseAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        const uint32_t center_row,
+        const uint32_t center_column,
+        const uint32_t row_radius,
+        const uint32_t column_radius,
+        const double angle = 0.0,
+        const bool filled = true
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        center_row(static_cast<int32_t>(center_row)),
+        center_column(static_cast<int32_t>(center_column)),
+        row_radius(row_radius),
+        column_radius(column_radius),
+        angle(angle),
+        filled(filled) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        spans.clear();
+        append_spans(center_row, center_column, row_radius, column_radius, angle, filled,
+                     drawer->get_canvas_height(), drawer->get_canvas_width(), spans);
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the rows of the shape that fall on a height x width canvas. The angle (radians)
+    // turns the column axis towards the row axis; equal radii at angle 0 give the disk whose
+    // border is the circle of CircleBresenhamAlgorithmExecutor.
+    static void append_spans(
+        const int32_t center_row,
+        const int32_t center_column,
+        const uint32_t row_radius,
+        const uint32_t column_radius,
+        const double angle,
+        const bool filled,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        constexpr int64_t RADIUS_LIMIT = int64_t {1} << 24;
+        if (row_radius >= RADIUS_LIMIT || column_radius >= RADIUS_LIMIT) {
+            throw std::out_of_range("Ellipse radii must stay below 2^24");
+        }
+
+        const bool rotated = std::fmod(angle, std::numbers::pi) != 0.0 && row_radius != column_radius;
+        const double a = column_radius;
+        const double b = row_radius;
+        const auto reach = rotated
+            ? static_cast<int64_t>(std::ceil(std::sqrt(a * a * std::sin(angle) * std::sin(angle) +
+                                                       b * b * std::cos(angle) * std::cos(angle))))
+            : static_cast<int64_t>(row_radius);
+
+        // One row of margin on both sides, so the outline can look at the neighbours of every visible row
+        const int64_t first = std::max<int64_t>(center_row - reach, -1);
+        const int64_t last = std::min<int64_t>(center_row + reach, height);
+        if (first > last) {
+            return;
+        }
+
+        std::vector<drawing::Span> rows;
+        if (rotated) {
+            rows = rotated_rows(center_row, center_column, std::max(a, 0.5), std::max(b, 0.5), angle, first, last);
+        } else if (row_radius == column_radius) {
+            rows = symmetric_rows(center_row, center_column, circle_half_widths(row_radius), first, last);
+        } else {
+            rows = symmetric_rows(center_row, center_column, ellipse_half_widths(column_radius, row_radius), first, last);
+        }
+
+        for (size_t index = 0; index < rows.size(); ++index) {
+            const drawing::Span& row = rows[index];
+            if (row.row < 0 || row.row >= height || is_empty(row) || row.end <= 0 || row.begin >= width) {
+                continue;
+            }
+            if (filled) {
+                out.push_back(row);
+            } else {
+                append_outline(rows, index, out);
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -2,74 +2,138 @@
 #define FILLING_ALGORITHM_EXECUTOR_H
 
 #include <string>
-#include <stack>
-#include <functional>
-#include <set>
-#include "Drawer.h"
 #include <vector>
+#include <cstdint>
+#include <utility>
+#include "Drawer.h"
 
 class FillingAlgorithmExecutor {
     std::string canvas_file;
     drawing::Point point{drawing::Point(0, 0)};
     drawing::Drawer* drawer;
+    bool in_place;
 
-public:
+    // One bit per pixel, row after row
+    class VisitedMap {
+        std::vector<uint64_t> words;
+        size_t width;
 
-    FillingAlgorithmExecutor(std::string canvas_file, const uint x, const uint y) :
-    canvas_file(std::move(canvas_file)) {
-        drawer = new drawing::BmpDrawer(this->canvas_file);
-        point.x = x;
-        point.y = y;
+    public:
+        VisitedMap(const size_t width, const size_t height) : words((width * height + 63) / 64, 0), width(width) {}
+
+        [[nodiscard]] bool test(const size_t row, const size_t column) const {
+            const size_t bit = row * width + column;
+            return words[bit / 64] >> (bit % 64) & 1;
+        }
+
+        void set(const size_t row, const size_t column) {
+            const size_t bit = row * width + column;
+            words[bit / 64] |= uint64_t {1} << (bit % 64);
+        }
+    };
+
+    struct Seed {
+        int32_t row;
+        int32_t column;
+    };
+
+    // Black pixels are the border, everything else inside it gets filled
+    static bool is_border(const uint8_t* pixel) {
+        return pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0;
     }
 
-    ~FillingAlgorithmExecutor() {
-        delete drawer;
+    static bool is_fillable(const bmp::ConstImageView& canvas, const VisitedMap& visited, const int32_t row, const int32_t column) {
+        return !visited.test(row, column) && !is_border(canvas.row(row) + column * canvas.bytes_per_pixel());
     }
 
-    void execute() const {
-        std::stack<drawing::Point> stack;
-        std::set<drawing::Point> initialized;
+    // Pushes one seed for every run of fillable pixels of the row within [left, right]
+    static void push_runs(const bmp::ConstImageView& canvas, const VisitedMap& visited, std::vector<Seed>& seeds,
+                          const int32_t row, const int32_t left, const int32_t right) {
+        if (row < 0 || row >= canvas.height) {
+            return;
+        }
+
+        bool in_run = false;
+        for (int32_t column = left; column <= right; ++column) {
+            const bool fillable = is_fillable(canvas, visited, row, column);
+            if (fillable && !in_run) {
+                seeds.push_back({row, column});
+            }
+            in_run = fillable;
+        }
+    }
 
-        stack.push(point);
+public:
+    // Scanline fill of the 4-connected region around the seed: every popped seed grows into the
+    // whole horizontal span it lies on and only the runs of the rows above and below are queued,
+    // so the stack holds spans rather than pixels. The visited map keeps the canvas untouched
+    // until all spans have been found and are handed to the drawer as one batch.
+    static std::vector<drawing::Span> fill(const bmp::ConstImageView& canvas, const int32_t seed_row, const int32_t seed_column) {
+        if (canvas.bit_count != 24 && canvas.bit_count != 32) {
+            throw std::runtime_error("Non-RGB image: impossible to parse");
+        }
+        if (seed_row < 0 || seed_row >= canvas.height || seed_column < 0 || seed_column >= canvas.width) {
+            throw std::runtime_error("Filling start point lies outside the canvas");
+        }
 
-        while (!stack.empty()) {
-            auto current = stack.top();
-            stack.pop();
+        std::vector<drawing::Span> spans;
+        VisitedMap visited(canvas.width, canvas.height);
+        std::vector<Seed> seeds {{seed_row, seed_column}};
 
-            drawer->draw(current);
+        while (!seeds.empty()) {
+            const Seed seed = seeds.back();
+            seeds.pop_back();
+
+            if (!is_fillable(canvas, visited, seed.row, seed.column)) {
+                continue;
+            }
 
-            initialized.insert(current);
+            int32_t left = seed.column;
+            while (left > 0 && is_fillable(canvas, visited, seed.row, left - 1)) {
+                --left;
+            }
+            int32_t right = seed.column;
+            while (right + 1 < canvas.width && is_fillable(canvas, visited, seed.row, right + 1)) {
+                ++right;
+            }
 
-            std::function border_condition = [this] (const drawing::Point& point) -> bool {
-                const auto bmp_drawer = dynamic_cast<drawing::BmpDrawer*>(drawer);
-                if (!bmp_drawer) {
-                    throw std::runtime_error("Unknown way to define borders: unknown file type");
-                }
+            for (int32_t column = left; column <= right; ++column) {
+                visited.set(seed.row, column);
+            }
+            spans.push_back({seed.row, left, right + 1});
 
-                const bmp::BmpHandler& handler = bmp_drawer->get_handler();
-                const auto colors = handler.get_color_value(point);
+            push_runs(canvas, visited, seeds, seed.row - 1, left, right);
+            push_runs(canvas, visited, seeds, seed.row + 1, left, right);
+        }
 
-                if (colors.size() != 3) {
-                    throw std::runtime_error("Non-RGB image: impossible to parse");
-                }
+        return spans;
+    }
 
-                return colors[0] == 0 && colors[1] == 0 && colors[2] == 0;
-            };
+    // With in_place the filled canvas is saved over canvas_file, writing only the filled rows;
+    // otherwise it goes to a copy with a _filled suffix
+    FillingAlgorithmExecutor(std::string canvas_file, const uint x, const uint y, const bool in_place = false) :
+    canvas_file(std::move(canvas_file)), in_place(in_place) {
+        drawer = new drawing::BmpDrawer(this->canvas_file);
+        point.x = x;
+        point.y = y;
+    }
 
-            std::vector<drawing::Point> neighbours;
-            neighbours.emplace_back(current.x + 1, current.y);
-            neighbours.emplace_back(current.x, current.y + 1);
-            neighbours.emplace_back(current.x - 1, current.y);
-            neighbours.emplace_back(current.x, current.y - 1);
+    ~FillingAlgorithmExecutor() {
+        delete drawer;
+    }
 
-            for (auto neighbour : neighbours) {
-                if (!initialized.contains(neighbour) && !border_condition(neighbour)) {
-                    stack.push(neighbour);
-                }
-            }
+    void execute() const {
+        const auto bmp_drawer = dynamic_cast<drawing::BmpDrawer*>(drawer);
+        if (!bmp_drawer) {
+            throw std::runtime_error("Unknown way to define borders: unknown file type");
         }
 
-        drawer->save(canvas_file.substr(0, canvas_file.length() - 4) + "_filled.bmp");
+        bmp_drawer->synchronize();
+        const auto spans = fill(std::as_const(*bmp_drawer).get_handler().view(),
+                                static_cast<int32_t>(point.x), static_cast<int32_t>(point.y));
+        drawer->draw(spans);
+
+        drawer->save(in_place ? canvas_file : canvas_file.substr(0, canvas_file.length() - 4) + "_filled.bmp");
     }
 };
 
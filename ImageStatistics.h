@@ -0,0 +1,165 @@
+#ifndef IMAGE_STATISTICS_H
+#define IMAGE_STATISTICS_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace bmp {
+
+    struct ChannelStatistics {
+        std::array<uint64_t, 256> histogram {};
+        uint64_t count {0};
+        uint8_t min {0};
+        uint8_t max {0};
+        double mean {0.0};
+        double standard_deviation {0.0};
+
+        // Smallest value v such that at least p percent of the samples are <= v
+        [[nodiscard]] uint8_t percentile(const double p) const {
+            if (count == 0) {
+                return 0;
+            }
+
+            const auto target = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * count));
+            uint64_t cumulative = 0;
+            for (int value = 0; value < 256; ++value) {
+                cumulative += histogram[value];
+                if (cumulative >= std::max<uint64_t>(target, 1)) {
+                    return static_cast<uint8_t>(value);
+                }
+            }
+            return max;
+        }
+
+        [[nodiscard]] uint8_t median() const {
+            return percentile(50.0);
+        }
+
+        // Everything else is derived from the histogram in O(256)
+        void finalize() {
+            count = 0;
+            double sum = 0.0;
+            double sum_of_squares = 0.0;
+            bool seen = false;
+
+            for (int value = 0; value < 256; ++value) {
+                const uint64_t n = histogram[value];
+                if (n == 0) {
+                    continue;
+                }
+                if (!seen) {
+                    min = static_cast<uint8_t>(value);
+                    seen = true;
+                }
+                max = static_cast<uint8_t>(value);
+                count += n;
+                sum += static_cast<double>(n) * value;
+                sum_of_squares += static_cast<double>(n) * value * value;
+            }
+
+            if (count == 0) {
+                return;
+            }
+
+            mean = sum / static_cast<double>(count);
+            standard_deviation = std::sqrt(std::max(0.0, sum_of_squares / static_cast<double>(count) - mean * mean));
+        }
+    };
+
+    // Per-channel summary of an image. Channels follow the memory order of a pixel
+    // (blue, green, red[, alpha]); indexed images have one channel holding palette indices.
+    struct ImageStatistics {
+        std::vector<ChannelStatistics> channels;
+
+        // One pass over the pixels, skipping row padding. Every thread counts into private
+        // histograms and the results are merged, so no counter is shared while counting.
+        static ImageStatistics compute(const ConstImageView& view) {
+            if (view.bit_count != 1 && view.bit_count != 2 && view.bit_count != 4 &&
+                view.bit_count != 8 && view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("ImageStatistics: unsupported bit count");
+            }
+
+            const int channel_count = view.bit_count <= 8 ? 1 : view.bytes_per_pixel();
+            ImageStatistics statistics;
+            statistics.channels.resize(channel_count);
+            std::mutex merge_mutex;
+
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                std::vector<uint32_t> local(static_cast<size_t>(channel_count) * LANES * 256, 0);
+                count_rows(view, static_cast<int32_t>(first), static_cast<int32_t>(last), channel_count, local);
+
+                const std::lock_guard lock(merge_mutex);
+                for (int channel = 0; channel < channel_count; ++channel) {
+                    auto& histogram = statistics.channels[channel].histogram;
+                    for (int lane = 0; lane < LANES; ++lane) {
+                        const uint32_t* counts = local.data() + (channel * LANES + lane) * 256;
+                        for (int value = 0; value < 256; ++value) {
+                            histogram[value] += counts[value];
+                        }
+                    }
+                }
+            }, 64);
+
+            for (auto& channel : statistics.channels) {
+                channel.finalize();
+            }
+            return statistics;
+        }
+
+    private:
+        // Consecutive pixels often share a value; spreading them over several sub-histograms
+        // keeps successive increments from waiting on the same counter. A lane sees a quarter
+        // of the pixels, so 32-bit counters are enough for images of up to 2^34 pixels.
+        static constexpr int LANES = 4;
+
+        static void count_rows(const ConstImageView& view, const int32_t first, const int32_t last,
+                               const int channel_count, std::vector<uint32_t>& counts) {
+            if (view.bit_count < 8) {
+                const int bits = view.bit_count;
+                const int per_byte = 8 / bits;
+                const auto mask = static_cast<uint8_t>((1 << bits) - 1);
+                for (int32_t y = first; y < last; ++y) {
+                    const uint8_t* row = view.row(y);
+                    for (int32_t x = 0; x < view.width; ++x) {
+                        const int shift = 8 - bits * (x % per_byte + 1);
+                        ++counts[(x % LANES) * 256 + ((row[x / per_byte] >> shift) & mask)];
+                    }
+                }
+                return;
+            }
+
+            for (int32_t y = first; y < last; ++y) {
+                const uint8_t* row = view.row(y);
+                if (channel_count == 1) {
+                    int32_t x = 0;
+                    for (; x + LANES <= view.width; x += LANES) {
+                        ++counts[0 * 256 + row[x]];
+                        ++counts[1 * 256 + row[x + 1]];
+                        ++counts[2 * 256 + row[x + 2]];
+                        ++counts[3 * 256 + row[x + 3]];
+                    }
+                    for (; x < view.width; ++x) {
+                        ++counts[row[x]];
+                    }
+                } else {
+                    for (int32_t x = 0; x < view.width; ++x) {
+                        const uint8_t* pixel = row + x * channel_count;
+                        const int lane = x % LANES;
+                        for (int channel = 0; channel < channel_count; ++channel) {
+                            ++counts[(channel * LANES + lane) * 256 + pixel[channel]];
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
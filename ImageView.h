@@ -0,0 +1,46 @@
+#ifndef IMAGE_VIEW_H
+#define IMAGE_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace bmp {
+
+    // Non-owning window onto pixel rows: row y starts at data + y * stride.
+    // BmpHandler keeps rows top-down in memory, so view row 0 is the top of the picture.
+    template<typename T>
+    struct BasicImageView {
+        T* data {nullptr};
+        int32_t width {0};
+        int32_t height {0};
+        std::ptrdiff_t stride {0};
+        uint16_t bit_count {0};
+
+        [[nodiscard]] T* row(const int32_t y) const {
+            return data + y * stride;
+        }
+
+        [[nodiscard]] int bytes_per_pixel() const {
+            return bit_count / 8;
+        }
+
+        [[nodiscard]] std::size_t row_size_in_bytes() const {
+            return (static_cast<std::size_t>(width) * bit_count + 7) / 8;
+        }
+
+        // O(1): the same pixels seen upside down, by starting at the last row and walking back
+        [[nodiscard]] BasicImageView flipped_vertically() const {
+            return {height > 0 ? row(height - 1) : data, width, height, -stride, bit_count};
+        }
+
+        operator BasicImageView<const T>() const requires (!std::is_const_v<T>) {
+            return {data, width, height, stride, bit_count};
+        }
+    };
+
+    using ImageView = BasicImageView<uint8_t>;
+    using ConstImageView = BasicImageView<const uint8_t>;
+}
+
+#endif
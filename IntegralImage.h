@@ -0,0 +1,180 @@
+#ifndef INTEGRAL_IMAGE_H
+#define INTEGRAL_IMAGE_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace bmp {
+
+    // Summed-area table of an 8-bit image, optionally with a second table of squared values.
+    // Entry (x, y) holds the sum over [0, x) x [0, y), so any rectangle costs four lookups.
+    // Sum is uint32_t or uint64_t; construction refuses a type that could overflow.
+    template<typename Sum = uint64_t>
+    class IntegralImage {
+        static_assert(std::is_same_v<Sum, uint32_t> || std::is_same_v<Sum, uint64_t>,
+                      "IntegralImage: Sum must be uint32_t or uint64_t");
+
+        static constexpr int32_t COLUMN_BLOCK = 256;
+
+        int32_t width;
+        int32_t height;
+        std::vector<Sum> sums;
+        std::vector<Sum> squares;
+
+        [[nodiscard]] size_t index(const int32_t x, const int32_t y) const {
+            return static_cast<size_t>(y) * (width + 1) + x;
+        }
+
+        [[nodiscard]] Sum lookup(const std::vector<Sum>& table, const int32_t x0, const int32_t y0,
+                                 const int32_t x1, const int32_t y1) const {
+            return table[index(x1, y1)] - table[index(x0, y1)] - table[index(x1, y0)] + table[index(x0, y0)];
+        }
+
+        // Pass 1: every row becomes its own prefix sum, rows are independent
+        void build_row_prefixes(const ConstImageView& view) {
+            parallel::for_each_range(0, height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* row = view.row(y);
+                    Sum* out = sums.data() + index(1, y + 1);
+                    Sum* out_squares = squares.empty() ? nullptr : squares.data() + index(1, y + 1);
+                    Sum running = 0;
+                    Sum running_squares = 0;
+                    for (int32_t x = 0; x < width; ++x) {
+                        running += row[x];
+                        out[x] = running;
+                        if (out_squares) {
+                            running_squares += static_cast<Sum>(row[x]) * row[x];
+                            out_squares[x] = running_squares;
+                        }
+                    }
+                }
+            }, 64);
+        }
+
+        // Pass 2: accumulate down the columns, one block of columns per task so the
+        // inner loop adds two contiguous row segments
+        void build_column_prefixes() {
+            const int64_t blocks = (width + 1 + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+
+            parallel::for_each_range(0, blocks, [&](const int64_t first, const int64_t last) {
+                const auto x_begin = static_cast<int32_t>(first * COLUMN_BLOCK);
+                const auto x_end = static_cast<int32_t>(std::min<int64_t>(last * COLUMN_BLOCK, width + 1));
+
+                for (std::vector<Sum>* table : {&sums, &squares}) {
+                    if (table->empty()) {
+                        continue;
+                    }
+                    for (int32_t y = 1; y <= height; ++y) {
+                        Sum* row = table->data() + index(0, y);
+                        const Sum* above = table->data() + index(0, y - 1);
+                        for (int32_t x = x_begin; x < x_end; ++x) {
+                            row[x] += above[x];
+                        }
+                    }
+                }
+            });
+        }
+
+    public:
+        IntegralImage(const ConstImageView& view, const bool with_squares = false) :
+            width(view.width), height(view.height) {
+            if (view.bit_count != 8) {
+                throw std::runtime_error("IntegralImage: only 8-bit images are supported");
+            }
+            if (!fits(width, height, with_squares)) {
+                throw std::overflow_error("IntegralImage: sums do not fit the chosen integer type");
+            }
+
+            sums.assign(static_cast<size_t>(width + 1) * (height + 1), 0);
+            if (with_squares) {
+                squares.assign(sums.size(), 0);
+            }
+
+            build_row_prefixes(view);
+            build_column_prefixes();
+        }
+
+        static bool fits(const int32_t width, const int32_t height, const bool with_squares) {
+            const long double largest = static_cast<long double>(width) * height * (with_squares ? 255.0L * 255.0L : 255.0L);
+            return largest <= static_cast<long double>(std::numeric_limits<Sum>::max());
+        }
+
+        [[nodiscard]] int32_t get_width() const { return width; }
+
+        [[nodiscard]] int32_t get_height() const { return height; }
+
+        [[nodiscard]] bool has_squares() const { return !squares.empty(); }
+
+        // Rectangle [x0, x1) x [y0, y1)
+        [[nodiscard]] Sum sum(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1) const {
+            return lookup(sums, x0, y0, x1, y1);
+        }
+
+        [[nodiscard]] Sum sum_of_squares(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1) const {
+            if (squares.empty()) {
+                throw std::logic_error("IntegralImage: built without squared sums");
+            }
+            return lookup(squares, x0, y0, x1, y1);
+        }
+
+        [[nodiscard]] double mean(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1) const {
+            const auto area = static_cast<double>(x1 - x0) * (y1 - y0);
+            return area > 0 ? static_cast<double>(sum(x0, y0, x1, y1)) / area : 0.0;
+        }
+
+        [[nodiscard]] double variance(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1) const {
+            const auto area = static_cast<double>(x1 - x0) * (y1 - y0);
+            if (area <= 0) {
+                return 0.0;
+            }
+            const double average = mean(x0, y0, x1, y1);
+            return std::max(0.0, static_cast<double>(sum_of_squares(x0, y0, x1, y1)) / area - average * average);
+        }
+    };
+
+    enum class AdaptiveThresholdMethod {
+        BRADLEY,    // darker than the local mean by more than k (a fraction, e.g. 0.15)
+        SAUVOLA     // below m * (1 + k * (s / 128 - 1)), k around 0.2..0.5
+    };
+
+    struct AdaptiveThresholdParameters {
+        AdaptiveThresholdMethod method {AdaptiveThresholdMethod::SAUVOLA};
+        int32_t radius {7};     // the window is (2 * radius + 1) squared, cut at the image edges
+        double k {0.2};
+    };
+
+    // Per-pixel white/black decision over one row, so the packer never needs a threshold image
+    template<typename Sum>
+    void adaptive_threshold_row(const IntegralImage<Sum>& integral, const uint8_t* row, const int32_t y,
+                                const AdaptiveThresholdParameters& parameters, uint8_t* is_white) {
+        const int32_t y0 = std::max(0, y - parameters.radius);
+        const int32_t y1 = std::min(integral.get_height(), y + parameters.radius + 1);
+        constexpr double dynamic_range = 128.0;
+
+        for (int32_t x = 0; x < integral.get_width(); ++x) {
+            const int32_t x0 = std::max(0, x - parameters.radius);
+            const int32_t x1 = std::min(integral.get_width(), x + parameters.radius + 1);
+            const auto area = static_cast<double>(x1 - x0) * (y1 - y0);
+            const auto sum = static_cast<double>(integral.sum(x0, y0, x1, y1));
+
+            if (parameters.method == AdaptiveThresholdMethod::BRADLEY) {
+                is_white[x] = row[x] * area > sum * (1.0 - parameters.k);
+                continue;
+            }
+
+            const double mean = sum / area;
+            const double variance = static_cast<double>(integral.sum_of_squares(x0, y0, x1, y1)) / area - mean * mean;
+            const double deviation = std::sqrt(std::max(0.0, variance));
+            is_white[x] = row[x] > mean * (1.0 + parameters.k * (deviation / dynamic_range - 1.0));
+        }
+    }
+}
+
+#endif
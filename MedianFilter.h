@@ -0,0 +1,240 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include "Convolution.h"
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace bmp {
+
+    // Median filter for 8-bit planes and every channel of 24/32-bit images.
+    // Radius 1 uses a sorting network; larger radii use the constant-time histogram method of
+    // Perreault and Hebert ("Median Filtering in Constant Time", 2007), run on parallel vertical strips.
+    class MedianFilter {
+        static constexpr int32_t MAX_RADIUS = 127;           // (2r + 1)^2 must fit a 16-bit bin
+        static constexpr int32_t MIN_STRIP_WIDTH = 64;
+
+        static void sort_pair(uint8_t& a, uint8_t& b) {
+            const uint8_t low = std::min(a, b);
+            b = std::max(a, b);
+            a = low;
+        }
+
+        // 19 compare-exchanges (Paeth); branch-free min/max, so the loop over a row vectorizes
+        static uint8_t median_of_9(uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3, uint8_t p4,
+                                   uint8_t p5, uint8_t p6, uint8_t p7, uint8_t p8) {
+            sort_pair(p1, p2); sort_pair(p4, p5); sort_pair(p7, p8);
+            sort_pair(p0, p1); sort_pair(p3, p4); sort_pair(p6, p7);
+            sort_pair(p1, p2); sort_pair(p4, p5); sort_pair(p7, p8);
+            sort_pair(p0, p3); sort_pair(p5, p8); sort_pair(p4, p7);
+            sort_pair(p3, p6); sort_pair(p1, p4); sort_pair(p2, p5);
+            sort_pair(p4, p7); sort_pair(p4, p2); sort_pair(p6, p4);
+            sort_pair(p4, p2);
+            return p4;
+        }
+
+        static void median_3x3(const ConstImageView& src, const ImageView& dst, const BorderMode border,
+                               const uint8_t border_value) {
+            const int channels = src.bytes_per_pixel();
+            const size_t row_bytes = static_cast<size_t>(src.width) * channels;
+            const size_t padded_bytes = row_bytes + 2 * channels;
+
+            parallel::for_each_range(0, src.height, [&](const int64_t first, const int64_t last) {
+                std::vector<uint8_t> rows(3 * padded_bytes);
+
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    for (int32_t k = 0; k < 3; ++k) {
+                        pad_row(src, y - 1 + k, 1, border, border_value, rows.data() + k * padded_bytes);
+                    }
+
+                    const uint8_t* top = rows.data();
+                    const uint8_t* middle = top + padded_bytes;
+                    const uint8_t* bottom = middle + padded_bytes;
+                    uint8_t* out = dst.row(y);
+
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        const size_t c = i + channels;
+                        out[i] = median_of_9(
+                            top[i], top[c], top[c + channels],
+                            middle[i], middle[c], middle[c + channels],
+                            bottom[i], bottom[c], bottom[c + channels]
+                        );
+                    }
+                }
+            }, 8);
+        }
+
+        // Histograms for one strip and one channel. Fine bins are stored as 16 coarse buckets of
+        // 16 bins, so bringing a bucket of the kernel histogram up to date is a 16-lane add.
+        struct StripHistograms {
+            int32_t columns;
+            std::vector<uint16_t> column_coarse;   // columns x 16
+            std::vector<uint16_t> column_fine;     // columns x 256
+            std::array<uint16_t, 16> kernel_coarse {};
+            std::array<uint16_t, 256> kernel_fine {};
+            std::array<int32_t, 16> last_updated {};
+
+            explicit StripHistograms(const int32_t columns) :
+                columns(columns), column_coarse(columns * 16), column_fine(columns * 256) {}
+
+            void add(const int32_t column, const uint8_t value) {
+                ++column_coarse[column * 16 + (value >> 4)];
+                ++column_fine[column * 256 + value];
+            }
+
+            void remove(const int32_t column, const uint8_t value) {
+                --column_coarse[column * 16 + (value >> 4)];
+                --column_fine[column * 256 + value];
+            }
+        };
+
+        static void median_strip(const ConstImageView& src, const ImageView& dst, const int32_t radius,
+                                 const BorderMode border, const uint8_t border_value,
+                                 const int32_t x_begin, const int32_t x_end) {
+            const int channels = src.bytes_per_pixel();
+            const int32_t window = 2 * radius + 1;
+            const auto rank = static_cast<uint32_t>(window * window / 2);
+            const int32_t strip_columns = x_end - x_begin + 2 * radius;
+
+            // Source column of every padded strip column, -1 for the constant border
+            std::vector<int32_t> source_columns(strip_columns);
+            for (int32_t j = 0; j < strip_columns; ++j) {
+                source_columns[j] = map_border_index(x_begin - radius + j, src.width, border);
+            }
+
+            auto sample = [&](const int32_t y, const int32_t j, const int channel) -> uint8_t {
+                const int32_t source_y = map_border_index(y, src.height, border);
+                if (source_y < 0 || source_columns[j] < 0) {
+                    return border_value;
+                }
+                return src.row(source_y)[source_columns[j] * channels + channel];
+            };
+
+            StripHistograms histograms(strip_columns);
+
+            for (int channel = 0; channel < channels; ++channel) {
+                std::fill(histograms.column_coarse.begin(), histograms.column_coarse.end(), 0);
+                std::fill(histograms.column_fine.begin(), histograms.column_fine.end(), 0);
+
+                for (int32_t j = 0; j < strip_columns; ++j) {
+                    for (int32_t y = -radius; y <= radius; ++y) {
+                        histograms.add(j, sample(y, j, channel));
+                    }
+                }
+
+                for (int32_t y = 0; y < src.height; ++y) {
+                    if (y > 0) {
+                        for (int32_t j = 0; j < strip_columns; ++j) {
+                            histograms.remove(j, sample(y - radius - 1, j, channel));
+                            histograms.add(j, sample(y + radius, j, channel));
+                        }
+                    }
+
+                    histograms.kernel_coarse.fill(0);
+                    histograms.kernel_fine.fill(0);
+                    histograms.last_updated.fill(0);
+                    for (int32_t j = 0; j < window - 1; ++j) {
+                        for (int k = 0; k < 16; ++k) {
+                            histograms.kernel_coarse[k] += histograms.column_coarse[j * 16 + k];
+                        }
+                    }
+
+                    uint8_t* out = dst.row(y);
+                    for (int32_t x = x_begin; x < x_end; ++x) {
+                        const int32_t start = x - x_begin;     // first strip column of the window
+                        const int32_t incoming = start + window - 1;
+
+                        for (int k = 0; k < 16; ++k) {
+                            histograms.kernel_coarse[k] += histograms.column_coarse[incoming * 16 + k];
+                        }
+
+                        out[x * channels + channel] = select(histograms, rank, start, window);
+
+                        for (int k = 0; k < 16; ++k) {
+                            histograms.kernel_coarse[k] -= histograms.column_coarse[start * 16 + k];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Finds the coarse bucket holding the median, then updates only that bucket's fine bins:
+        // incrementally when it was used recently, from scratch when the window moved past it
+        static uint8_t select(StripHistograms& histograms, const uint32_t rank, const int32_t start, const int32_t window) {
+            uint32_t count = 0;
+            int bucket = 0;
+            for (; bucket < 15; ++bucket) {
+                if (count + histograms.kernel_coarse[bucket] > rank) {
+                    break;
+                }
+                count += histograms.kernel_coarse[bucket];
+            }
+
+            uint16_t* fine = histograms.kernel_fine.data() + bucket * 16;
+            int32_t& last_updated = histograms.last_updated[bucket];
+            const int32_t end = start + window;
+
+            if (last_updated <= start) {
+                std::fill_n(fine, 16, 0);
+                for (int32_t j = start; j < end; ++j) {
+                    const uint16_t* column = histograms.column_fine.data() + j * 256 + bucket * 16;
+                    for (int k = 0; k < 16; ++k) {
+                        fine[k] += column[k];
+                    }
+                }
+            } else {
+                for (int32_t j = last_updated; j < end; ++j) {
+                    const uint16_t* added = histograms.column_fine.data() + j * 256 + bucket * 16;
+                    const uint16_t* removed = histograms.column_fine.data() + (j - window) * 256 + bucket * 16;
+                    for (int k = 0; k < 16; ++k) {
+                        fine[k] += added[k] - removed[k];
+                    }
+                }
+            }
+            last_updated = end;
+
+            for (int k = 0; k < 16; ++k) {
+                count += fine[k];
+                if (count > rank) {
+                    return static_cast<uint8_t>(bucket * 16 + k);
+                }
+            }
+            return static_cast<uint8_t>(bucket * 16 + 15);
+        }
+
+    public:
+        // src and dst must not overlap
+        static void apply(const ConstImageView& src, const ImageView& dst, const int32_t radius,
+                          const BorderMode border = BorderMode::CLAMP, const uint8_t border_value = 0) {
+            if (src.bit_count != 8 && src.bit_count != 24 && src.bit_count != 32) {
+                throw std::runtime_error("MedianFilter: only 8, 24 and 32-bit images are supported");
+            }
+            if (radius < 0 || radius > MAX_RADIUS) {
+                throw std::invalid_argument("MedianFilter: radius must be within [0, 127]");
+            }
+
+            if (radius == 0) {
+                for (int32_t y = 0; y < src.height; ++y) {
+                    std::copy_n(src.row(y), src.row_size_in_bytes(), dst.row(y));
+                }
+                return;
+            }
+
+            if (radius == 1) {
+                median_3x3(src, dst, border, border_value);
+                return;
+            }
+
+            parallel::for_each_range(0, src.width, [&](const int64_t first, const int64_t last) {
+                median_strip(src, dst, radius, border, border_value, static_cast<int32_t>(first), static_cast<int32_t>(last));
+            }, MIN_STRIP_WIDTH);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef NOISE_GENERATOR_H
+#define NOISE_GENERATOR_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace bmp {
+
+    enum class NoiseModel {
+        SALT_AND_PEPPER,
+        GAUSSIAN,
+        UNIFORM
+    };
+
+    struct NoiseParameters {
+        NoiseModel model {NoiseModel::SALT_AND_PEPPER};
+        double density {0.05};      // share of pixels to change, 0..1
+        double amplitude {32.0};    // sigma for GAUSSIAN, half-range for UNIFORM, in intensity levels
+        uint64_t seed {0};
+    };
+
+    // Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+    // The output is a pure function of (counter, key), so any pixel can be generated
+    // independently and the result does not depend on how rows are split between threads.
+    class Philox4x32 {
+        static constexpr uint32_t M0 = 0xD2511F53;
+        static constexpr uint32_t M1 = 0xCD9E8D57;
+        static constexpr uint32_t W0 = 0x9E3779B9;
+        static constexpr uint32_t W1 = 0xBB67AE85;
+
+    public:
+        static constexpr int BLOCK = 8;
+
+        using Block = std::array<std::array<uint32_t, BLOCK>, 4>;
+
+        // Generates BLOCK consecutive counters starting at first_counter in structure-of-arrays form,
+        // so every round is a plain loop over lanes the compiler can vectorize.
+        static void generate(const uint64_t first_counter, const uint32_t stream, const uint64_t key, Block& out) {
+            std::array<uint32_t, BLOCK> c0, c1, c2, c3;
+            for (int lane = 0; lane < BLOCK; ++lane) {
+                const uint64_t counter = first_counter + lane;
+                c0[lane] = static_cast<uint32_t>(counter);
+                c1[lane] = static_cast<uint32_t>(counter >> 32);
+                c2[lane] = stream;
+                c3[lane] = 0;
+            }
+
+            uint32_t k0 = static_cast<uint32_t>(key);
+            uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+            for (int round = 0; round < 10; ++round) {
+                for (int lane = 0; lane < BLOCK; ++lane) {
+                    const uint64_t product0 = static_cast<uint64_t>(M0) * c0[lane];
+                    const uint64_t product1 = static_cast<uint64_t>(M1) * c2[lane];
+
+                    const uint32_t next0 = static_cast<uint32_t>(product1 >> 32) ^ c1[lane] ^ k0;
+                    const uint32_t next2 = static_cast<uint32_t>(product0 >> 32) ^ c3[lane] ^ k1;
+
+                    c1[lane] = static_cast<uint32_t>(product1);
+                    c3[lane] = static_cast<uint32_t>(product0);
+                    c0[lane] = next0;
+                    c2[lane] = next2;
+                }
+                k0 += W0;
+                k1 += W1;
+            }
+
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+
+        static std::array<uint32_t, 4> generate(const uint64_t counter, const uint32_t stream, const uint64_t key) {
+            Block block;
+            generate(counter, stream, key, block);
+            return {block[0][0], block[1][0], block[2][0], block[3][0]};
+        }
+    };
+
+    class NoiseGenerator {
+        NoiseParameters parameters;
+        uint64_t hit_threshold;   // a pixel is hit when its first random word is below it
+
+        static constexpr int MIN_ROWS_PER_THREAD = 16;
+
+        static float to_unit_interval(const uint32_t value) {
+            return (static_cast<float>(value >> 8) + 0.5f) * (1.0f / 16777216.0f);
+        }
+
+        static uint8_t saturate(const float value) {
+            return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+        }
+
+        // Fills three per-channel offsets for the pixel whose random words are r1..r3
+        void make_offsets(const uint64_t pixel, const uint32_t r1, const uint32_t r2, const uint32_t r3,
+                          std::array<float, 3>& offsets) const {
+            if (parameters.model == NoiseModel::UNIFORM) {
+                const auto amplitude = static_cast<float>(parameters.amplitude);
+                offsets[0] = (2.0f * to_unit_interval(r1) - 1.0f) * amplitude;
+                offsets[1] = (2.0f * to_unit_interval(r2) - 1.0f) * amplitude;
+                offsets[2] = (2.0f * to_unit_interval(r3) - 1.0f) * amplitude;
+                return;
+            }
+
+            // Box-Muller: every pair of uniforms gives two normals, the third channel takes a second draw
+            const auto extra = Philox4x32::generate(pixel, 1, parameters.seed);
+            const auto sigma = static_cast<float>(parameters.amplitude);
+            constexpr float two_pi = 6.28318530718f;
+
+            const float radius0 = std::sqrt(-2.0f * std::log(to_unit_interval(r1))) * sigma;
+            const float radius1 = std::sqrt(-2.0f * std::log(to_unit_interval(r3))) * sigma;
+            offsets[0] = radius0 * std::cos(two_pi * to_unit_interval(r2));
+            offsets[1] = radius0 * std::sin(two_pi * to_unit_interval(r2));
+            offsets[2] = radius1 * std::cos(two_pi * to_unit_interval(extra[0]));
+        }
+
+        void apply_to_bytes(uint8_t* pixel, const int channels, const uint64_t index,
+                            const uint32_t r1, const uint32_t r2, const uint32_t r3) const {
+            if (parameters.model == NoiseModel::SALT_AND_PEPPER) {
+                const uint8_t value = (r1 & 1) ? 255 : 0;
+                for (int channel = 0; channel < channels; ++channel) {
+                    pixel[channel] = value;
+                }
+                return;
+            }
+
+            std::array<float, 3> offsets {};
+            make_offsets(index, r1, r2, r3, offsets);
+            for (int channel = 0; channel < channels; ++channel) {
+                pixel[channel] = saturate(static_cast<float>(pixel[channel]) + offsets[channel]);
+            }
+        }
+
+        // Pixels narrower than a byte have no intensity scale to add to, so every model
+        // degrades to salt-and-pepper on the lowest and highest palette index
+        static void apply_to_bits(uint8_t* row, const int32_t x, const int bit_count, const uint32_t r1) {
+            const int bit_offset = x * bit_count;
+            const int shift = 8 - bit_count - bit_offset % 8;
+            const auto mask = static_cast<uint8_t>(((1 << bit_count) - 1) << shift);
+            uint8_t& byte = row[bit_offset / 8];
+            byte = (r1 & 1) ? (byte | mask) : (byte & ~mask);
+        }
+
+        void apply_to_rows(const ImageView& view, const int32_t first_row, const int32_t last_row) const {
+            const int bytes_per_pixel = view.bytes_per_pixel();
+            const int channels = std::min(bytes_per_pixel, 3);   // alpha is left untouched
+            Philox4x32::Block block;
+
+            for (int32_t y = first_row; y < last_row; ++y) {
+                uint8_t* row = view.row(y);
+                const uint64_t row_start = static_cast<uint64_t>(y) * view.width;
+
+                for (int32_t x0 = 0; x0 < view.width; x0 += Philox4x32::BLOCK) {
+                    Philox4x32::generate(row_start + x0, 0, parameters.seed, block);
+
+                    const int lanes = std::min<int32_t>(Philox4x32::BLOCK, view.width - x0);
+                    for (int lane = 0; lane < lanes; ++lane) {
+                        if (block[0][lane] >= hit_threshold) {
+                            continue;
+                        }
+
+                        const int32_t x = x0 + lane;
+                        if (view.bit_count < 8) {
+                            apply_to_bits(row, x, view.bit_count, block[1][lane]);
+                        } else {
+                            apply_to_bytes(row + x * bytes_per_pixel, channels, row_start + x,
+                                           block[1][lane], block[2][lane], block[3][lane]);
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        explicit NoiseGenerator(const NoiseParameters& parameters) : parameters(parameters) {
+            if (parameters.density < 0.0 || parameters.density > 1.0) {
+                throw std::invalid_argument("NoiseGenerator: density must be within [0, 1]");
+            }
+            if (parameters.amplitude < 0.0) {
+                throw std::invalid_argument("NoiseGenerator: amplitude must not be negative");
+            }
+
+            hit_threshold = static_cast<uint64_t>(std::ldexp(parameters.density, 32));
+        }
+
+        void apply(const ImageView& view) const {
+            if (view.bit_count == 16) {
+                throw std::runtime_error("NoiseGenerator: 16-bit images are not supported");
+            }
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                apply_to_rows(view, static_cast<int32_t>(first), static_cast<int32_t>(last));
+            }, MIN_ROWS_PER_THREAD);
+        }
+    };
+}
+
+#endif
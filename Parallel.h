@@ -0,0 +1,66 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    inline unsigned thread_count() {
+        const unsigned count = std::thread::hardware_concurrency();
+        return count == 0 ? 1 : count;
+    }
+
+    // Splits [begin, end) into contiguous chunks of at least min_chunk items and calls
+    // fn(chunk_begin, chunk_end) for each of them, one chunk per thread.
+    // The calling thread takes the last chunk; the first exception thrown by any chunk is rethrown.
+    template<typename Function>
+    void for_each_range(const int64_t begin, const int64_t end, Function&& fn, const int64_t min_chunk = 1) {
+        const int64_t total = end - begin;
+        if (total <= 0) {
+            return;
+        }
+
+        const int64_t max_chunks = std::max<int64_t>(1, total / std::max<int64_t>(1, min_chunk));
+        const int64_t chunks = std::min<int64_t>(thread_count(), max_chunks);
+
+        if (chunks == 1) {
+            fn(begin, end);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(chunks);
+        threads.reserve(chunks - 1);
+
+        auto run_chunk = [&](const int64_t chunk) {
+            const int64_t chunk_begin = begin + total * chunk / chunks;
+            const int64_t chunk_end = begin + total * (chunk + 1) / chunks;
+            try {
+                fn(chunk_begin, chunk_end);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+
+        for (int64_t chunk = 0; chunk + 1 < chunks; ++chunk) {
+            threads.emplace_back(run_chunk, chunk);
+        }
+        run_chunk(chunks - 1);
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef PIXEL_BUFFER_H
+#define PIXEL_BUFFER_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bmp {
+
+    // Hands out memory that is already zero: large blocks are fresh anonymous mappings, small ones
+    // come from calloc. Value-initializing an element is therefore left out, so a vector resized
+    // into a new allocation touches none of its pages until they are written, and an untouched
+    // black canvas costs no memory at all. Growing a vector back over elements it has shrunk away
+    // does not zero them again; pixel buffers are only ever resized into fresh storage.
+    template<typename T>
+    struct ZeroPageAllocator {
+        using value_type = T;
+
+        static constexpr size_t MAPPING_THRESHOLD = size_t {1} << 20;
+
+        ZeroPageAllocator() = default;
+
+        template<typename U>
+        ZeroPageAllocator(const ZeroPageAllocator<U>&) noexcept {}
+
+        T* allocate(const size_t n) {
+            const size_t bytes = n * sizeof(T);
+#if defined(__unix__) || defined(__APPLE__)
+            if (bytes >= MAPPING_THRESHOLD) {
+                void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (block == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+                return static_cast<T*>(block);
+            }
+#endif
+            void* block = std::calloc(n, sizeof(T));
+            if (!block) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(block);
+        }
+
+        void deallocate(T* block, const size_t n) noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+            if (n * sizeof(T) >= MAPPING_THRESHOLD) {
+                munmap(block, n * sizeof(T));
+                return;
+            }
+#endif
+            std::free(block);
+        }
+
+        // Default construction keeps the zero the memory came with
+        template<typename U>
+        void construct(U* element) noexcept {
+            ::new (static_cast<void*>(element)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* element, Args&&... args) {
+            ::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        bool operator==(const ZeroPageAllocator<U>&) const noexcept {
+            return true;
+        }
+    };
+
+    using PixelBuffer = std::vector<uint8_t, ZeroPageAllocator<uint8_t>>;
+
+    // Paints every pixel of a view with one color, encoded as for drawing::Canvas (a palette index,
+    // or blue | green << 8 | red << 16, with the alpha of 32-bit pixels in the top byte). Each row
+    // is written from a 48-byte block holding a whole number of pixels of any format; padding
+    // bytes past the row are left alone.
+    class BackgroundFill {
+        static constexpr size_t BLOCK = 48;
+
+        static void fill_row(uint8_t* row, const size_t bytes, const uint8_t* block) {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+            for (; i + BLOCK <= bytes; i += BLOCK) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), a);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i + 16), b);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i + 32), c);
+            }
+#else
+            for (; i + BLOCK <= bytes; i += BLOCK) {
+                std::memcpy(row + i, block, BLOCK);
+            }
+#endif
+            std::memcpy(row + i, block, bytes - i);
+        }
+
+    public:
+        static void fill(const ImageView& view, const uint32_t value) {
+            uint8_t block[BLOCK];
+            if (view.bit_count < 8) {
+                const int bits = view.bit_count;
+                uint8_t byte = 0;
+                for (int i = 0; i < 8 / bits; ++i) {
+                    byte = static_cast<uint8_t>(byte << bits | (value & ((1 << bits) - 1)));
+                }
+                std::memset(block, byte, BLOCK);
+            } else {
+                const int bytes_per_pixel = view.bytes_per_pixel();
+                for (size_t i = 0; i < BLOCK; ++i) {
+                    block[i] = static_cast<uint8_t>(value >> (8 * (i % bytes_per_pixel)));
+                }
+            }
+
+            const size_t row_bytes = view.row_size_in_bytes();
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    fill_row(view.row(y), row_bytes, block);
+                }
+            }, 64);
+        }
+    };
+}
+
+#endif
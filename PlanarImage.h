@@ -0,0 +1,268 @@
+#ifndef PLANAR_IMAGE_H
+#define PLANAR_IMAGE_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace bmp {
+
+    // A 24 or 32-bit image split into one 8-bit plane per channel (blue, green, red[, alpha]).
+    // Every plane row starts on a 64-byte boundary, so each plane is an ordinary 8-bit
+    // ImageView and all 8-bit kernels run on it without 3- or 4-byte pixel strides.
+    class PlanarImage {
+        static constexpr std::ptrdiff_t ALIGNMENT = 64;
+
+        int32_t width {0};
+        int32_t height {0};
+        int channels {0};
+        std::ptrdiff_t stride {0};
+        std::unique_ptr<uint8_t[]> storage;
+        uint8_t* base {nullptr};
+
+        [[nodiscard]] uint8_t* plane_data(const int channel) const {
+            return base + channel * stride * height;
+        }
+
+#if defined(__SSSE3__)
+        // Byte selectors for 16 pixels of 24-bit data held in three registers: for every
+        // (register, plane) pair, which bytes of the register belong to the plane. 0x80 selects zero.
+        struct ShuffleMasks {
+            std::array<std::array<int8_t, 16>, 9> split {};     // [register * 3 + plane] -> plane
+            std::array<std::array<int8_t, 16>, 9> merge {};     // [register * 3 + plane] -> register
+        };
+
+        static constexpr ShuffleMasks make_masks() {
+            ShuffleMasks masks;
+            for (int reg = 0; reg < 3; ++reg) {
+                for (int plane = 0; plane < 3; ++plane) {
+                    for (int i = 0; i < 16; ++i) {
+                        const int source = 3 * i + plane;
+                        masks.split[reg * 3 + plane][i] = static_cast<int8_t>(source / 16 == reg ? source % 16 : 0x80);
+                        const int target = 16 * reg + i;
+                        masks.merge[reg * 3 + plane][i] = static_cast<int8_t>(target % 3 == plane ? target / 3 : 0x80);
+                    }
+                }
+            }
+            return masks;
+        }
+
+        static const ShuffleMasks& masks() {
+            static constexpr ShuffleMasks value = make_masks();
+            return value;
+        }
+
+        static __m128i mask(const std::array<int8_t, 16>& bytes) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data()));
+        }
+
+        static int32_t split_row_3(const uint8_t* in, uint8_t* const* out, const int32_t width) {
+            int32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i registers[3] = {
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 3)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 3 + 16)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 3 + 32))
+                };
+                for (int plane = 0; plane < 3; ++plane) {
+                    __m128i result = _mm_shuffle_epi8(registers[0], mask(masks().split[plane]));
+                    result = _mm_or_si128(result, _mm_shuffle_epi8(registers[1], mask(masks().split[3 + plane])));
+                    result = _mm_or_si128(result, _mm_shuffle_epi8(registers[2], mask(masks().split[6 + plane])));
+                    _mm_store_si128(reinterpret_cast<__m128i*>(out[plane] + x), result);
+                }
+            }
+            return x;
+        }
+
+        static int32_t merge_row_3(const uint8_t* const* in, uint8_t* out, const int32_t width) {
+            int32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i planes[3] = {
+                    _mm_load_si128(reinterpret_cast<const __m128i*>(in[0] + x)),
+                    _mm_load_si128(reinterpret_cast<const __m128i*>(in[1] + x)),
+                    _mm_load_si128(reinterpret_cast<const __m128i*>(in[2] + x))
+                };
+                for (int reg = 0; reg < 3; ++reg) {
+                    __m128i result = _mm_shuffle_epi8(planes[0], mask(masks().merge[reg * 3]));
+                    result = _mm_or_si128(result, _mm_shuffle_epi8(planes[1], mask(masks().merge[reg * 3 + 1])));
+                    result = _mm_or_si128(result, _mm_shuffle_epi8(planes[2], mask(masks().merge[reg * 3 + 2])));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 3 + reg * 16), result);
+                }
+            }
+            return x;
+        }
+#endif
+
+#if defined(__SSE2__)
+        // Three rounds of byte interleaving gather each channel of 16 BGRA pixels into one half-register
+        static int32_t split_row_4(const uint8_t* in, uint8_t* const* out, const int32_t width) {
+            int32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4));
+                const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4 + 16));
+                const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4 + 32));
+                const __m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4 + 48));
+
+                const __m128i t0 = _mm_unpacklo_epi8(a0, a1);
+                const __m128i t1 = _mm_unpackhi_epi8(a0, a1);
+                const __m128i t2 = _mm_unpacklo_epi8(a2, a3);
+                const __m128i t3 = _mm_unpackhi_epi8(a2, a3);
+
+                const __m128i u0 = _mm_unpacklo_epi8(t0, t1);
+                const __m128i u1 = _mm_unpackhi_epi8(t0, t1);
+                const __m128i u2 = _mm_unpacklo_epi8(t2, t3);
+                const __m128i u3 = _mm_unpackhi_epi8(t2, t3);
+
+                const __m128i v0 = _mm_unpacklo_epi8(u0, u1);   // b0..b7 g0..g7
+                const __m128i v1 = _mm_unpackhi_epi8(u0, u1);   // r0..r7 a0..a7
+                const __m128i v2 = _mm_unpacklo_epi8(u2, u3);   // b8..b15 g8..g15
+                const __m128i v3 = _mm_unpackhi_epi8(u2, u3);   // r8..r15 a8..a15
+
+                _mm_store_si128(reinterpret_cast<__m128i*>(out[0] + x), _mm_unpacklo_epi64(v0, v2));
+                _mm_store_si128(reinterpret_cast<__m128i*>(out[1] + x), _mm_unpackhi_epi64(v0, v2));
+                _mm_store_si128(reinterpret_cast<__m128i*>(out[2] + x), _mm_unpacklo_epi64(v1, v3));
+                _mm_store_si128(reinterpret_cast<__m128i*>(out[3] + x), _mm_unpackhi_epi64(v1, v3));
+            }
+            return x;
+        }
+
+        static int32_t merge_row_4(const uint8_t* const* in, uint8_t* out, const int32_t width) {
+            int32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(in[0] + x));
+                const __m128i g = _mm_load_si128(reinterpret_cast<const __m128i*>(in[1] + x));
+                const __m128i r = _mm_load_si128(reinterpret_cast<const __m128i*>(in[2] + x));
+                const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(in[3] + x));
+
+                const __m128i bg_low = _mm_unpacklo_epi8(b, g);
+                const __m128i bg_high = _mm_unpackhi_epi8(b, g);
+                const __m128i ra_low = _mm_unpacklo_epi8(r, a);
+                const __m128i ra_high = _mm_unpackhi_epi8(r, a);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_unpacklo_epi16(bg_low, ra_low));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 16), _mm_unpackhi_epi16(bg_low, ra_low));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 32), _mm_unpacklo_epi16(bg_high, ra_high));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 48), _mm_unpackhi_epi16(bg_high, ra_high));
+            }
+            return x;
+        }
+#endif
+
+        static int32_t split_row_simd(const uint8_t* in, uint8_t* const* out, const int channels, const int32_t width) {
+#if defined(__SSSE3__)
+            if (channels == 3) {
+                return split_row_3(in, out, width);
+            }
+#endif
+#if defined(__SSE2__)
+            if (channels == 4) {
+                return split_row_4(in, out, width);
+            }
+#endif
+            return 0;
+        }
+
+        static int32_t merge_row_simd(const uint8_t* const* in, uint8_t* out, const int channels, const int32_t width) {
+#if defined(__SSSE3__)
+            if (channels == 3) {
+                return merge_row_3(in, out, width);
+            }
+#endif
+#if defined(__SSE2__)
+            if (channels == 4) {
+                return merge_row_4(in, out, width);
+            }
+#endif
+            return 0;
+        }
+
+    public:
+        PlanarImage(const int32_t width, const int32_t height, const int channels) :
+            width(width), height(height), channels(channels),
+            stride((static_cast<std::ptrdiff_t>(width) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT) {
+            if (channels != 3 && channels != 4) {
+                throw std::invalid_argument("PlanarImage: only 3 and 4-channel images are supported");
+            }
+
+            storage = std::make_unique_for_overwrite<uint8_t[]>(stride * height * channels + ALIGNMENT);
+            const auto address = reinterpret_cast<std::uintptr_t>(storage.get());
+            base = storage.get() + (ALIGNMENT - static_cast<std::ptrdiff_t>(address % ALIGNMENT)) % ALIGNMENT;
+        }
+
+        // Splits interleaved 24 or 32-bit pixels into planes, one SIMD shuffle per 16 pixels
+        static PlanarImage from_interleaved(const ConstImageView& view) {
+            if (view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("PlanarImage: only 24 and 32-bit images can be split into planes");
+            }
+
+            PlanarImage image(view.width, view.height, view.bytes_per_pixel());
+
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* in = view.row(y);
+                    uint8_t* out[4] {};
+                    for (int c = 0; c < image.channels; ++c) {
+                        out[c] = image.plane(c).row(y);
+                    }
+
+                    for (int32_t x = split_row_simd(in, out, image.channels, image.width); x < image.width; ++x) {
+                        for (int c = 0; c < image.channels; ++c) {
+                            out[c][x] = in[x * image.channels + c];
+                        }
+                    }
+                }
+            }, 16);
+
+            return image;
+        }
+
+        // The inverse of from_interleaved; view must have this image's geometry
+        void to_interleaved(const ImageView& view) const {
+            if (view.width != width || view.height != height || view.bytes_per_pixel() != channels) {
+                throw std::invalid_argument("PlanarImage: target geometry differs");
+            }
+
+            parallel::for_each_range(0, height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* in[4] {};
+                    for (int c = 0; c < channels; ++c) {
+                        in[c] = plane(c).row(y);
+                    }
+                    uint8_t* out = view.row(y);
+
+                    for (int32_t x = merge_row_simd(in, out, channels, width); x < width; ++x) {
+                        for (int c = 0; c < channels; ++c) {
+                            out[x * channels + c] = in[c][x];
+                        }
+                    }
+                }
+            }, 16);
+        }
+
+        [[nodiscard]] int32_t get_width() const { return width; }
+
+        [[nodiscard]] int32_t get_height() const { return height; }
+
+        [[nodiscard]] int channel_count() const { return channels; }
+
+        [[nodiscard]] ImageView plane(const int channel) {
+            return {plane_data(channel), width, height, stride, 8};
+        }
+
+        [[nodiscard]] ConstImageView plane(const int channel) const {
+            return {plane_data(channel), width, height, stride, 8};
+        }
+    };
+}
+
+#endif
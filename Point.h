@@ -1,6 +1,8 @@
 #ifndef POINT_H
 #define POINT_H
 
+#include <cstdint>
+
 namespace drawing {
     struct Point {
         uint32_t x;
@@ -11,9 +13,23 @@ namespace drawing {
         Point(const uint32_t x, const uint32_t y) : x(x), y(y) {}
 
         bool operator<(const Point &other) const {
-            return x * x + y * y <= other.x * other.x + other.y * other.y;
+            return x < other.x || (x == other.x && y < other.y);
         }
     };
+
+    // Horizontal run of pixels [begin, end) in one row; signed so that runs may start off-canvas
+    struct Span {
+        int32_t row;
+        int32_t begin;
+        int32_t end;
+    };
+
+    // One pixel partly covered by a shape, alpha = 255 meaning fully covered
+    struct Coverage {
+        int32_t row;
+        int32_t column;
+        uint8_t alpha;
+    };
 };
 
 #endif
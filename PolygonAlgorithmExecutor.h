@@ -0,0 +1,291 @@
+#ifndef POLYGON_ALGORITHM_EXECUTOR_H
+#define POLYGON_ALGORITHM_EXECUTOR_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace curve_algorithms {
+
+enum class FillRule {
+    EVEN_ODD,   // inside where a ray crosses the outline an odd number of times
+    NONZERO     // inside where the outline winds around the pixel at least once
+};
+
+// Scanline polygon fill. Vertices lie on pixel centers, x being the row and y the column as
+// everywhere in drawing::Point; the polygon is closed implicitly and may self-intersect. A pixel
+// is filled when its center is inside, with the top and left edges inclusive, so polygons sharing
+// an edge never paint a pixel twice.
+//
+// Edges are sorted by their top row (the edge table). Walking down the rows, an edge joins the
+// active edge list on its top row and leaves it on its bottom row; its crossing column is kept as
+// an exact fraction stepped by constant differences. Tall polygons are cut into horizontal bands
+// that are rasterized in parallel, each band starting its own active list at its first row.
+class PolygonAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+public:
+    // One non-horizontal edge, as stored in the edge table
+    struct EdgeSource {
+        int64_t top;
+        int64_t bottom;
+        int64_t column0;    // column at row top
+        int64_t d_column;   // column change over height rows
+        int8_t winding;
+    };
+
+    using EdgeTable = std::vector<EdgeSource>;
+
+private:
+    std::vector<drawing::Point> vertices;
+    FillRule rule;
+
+    std::vector<drawing::Span> spans;
+
+    struct Edge {
+        int64_t top;        // first row crossed
+        int64_t bottom;     // first row no longer crossed
+        int64_t column;     // crossing on the current row: column + fraction / height
+        int64_t fraction;   // in [0, height)
+        int64_t height;
+        int64_t step;       // column change per row: step + step_fraction / height
+        int64_t step_fraction;
+        int8_t winding;     // +1 for edges going down, -1 for edges going up
+
+        // Moves the crossing to row, which must lie in [top, bottom)
+        void start_at(const int64_t row, const int64_t column0, const int64_t d_column) {
+            const int64_t numerator = d_column * (row - top);
+            column = column0 + floor_div(numerator, height);
+            fraction = numerator - floor_div(numerator, height) * height;
+        }
+
+        void advance() {
+            column += step;
+            fraction += step_fraction;
+            if (fraction >= height) {
+                fraction -= height;
+                ++column;
+            }
+        }
+
+        // First column whose center is at or right of the crossing
+        [[nodiscard]] int64_t ceiling() const {
+            return column + (fraction > 0);
+        }
+
+        [[nodiscard]] bool operator<(const Edge& other) const {
+            if (column != other.column) {
+                return column < other.column;
+            }
+            return fraction * other.height < other.fraction * height;
+        }
+    };
+
+    static int64_t floor_div(const int64_t a, const int64_t b) {
+        const int64_t quotient = a / b;
+        return quotient - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    static Edge make_edge(const EdgeSource& source, const int64_t row) {
+        Edge edge {};
+        edge.top = source.top;
+        edge.bottom = source.bottom;
+        edge.height = source.bottom - source.top;
+        edge.winding = source.winding;
+        edge.step = floor_div(source.d_column, edge.height);
+        edge.step_fraction = source.d_column - edge.step * edge.height;
+        edge.start_at(row, source.column0, source.d_column);
+        return edge;
+    }
+
+    static void append_row(const std::vector<Edge>& active, const int64_t row, const FillRule rule,
+                           const int64_t width, std::vector<drawing::Span>& out) {
+        int winding = 0;
+        int64_t begin = 0;
+        const size_t row_start = out.size();
+        for (const Edge& edge : active) {
+            const bool was_inside = rule == FillRule::EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+            winding += rule == FillRule::EVEN_ODD ? 1 : edge.winding;
+            const bool is_inside = rule == FillRule::EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+
+            if (!was_inside && is_inside) {
+                begin = edge.ceiling();
+            } else if (was_inside && !is_inside) {
+                const int64_t end = std::min(edge.ceiling(), width);
+                begin = std::max<int64_t>(begin, 0);
+                if (begin >= end) {
+                    continue;
+                }
+                // Crossings of different edges may touch; such runs are joined into one span
+                if (out.size() > row_start && out.back().end >= begin) {
+                    out.back().end = std::max(out.back().end, static_cast<int32_t>(end));
+                } else {
+                    out.push_back({static_cast<int32_t>(row), static_cast<int32_t>(begin), static_cast<int32_t>(end)});
+                }
+            }
+        }
+    }
+
+    // Rows [first, last) of the polygon; sources are sorted by top row
+    static void append_band(const EdgeTable& sources, const int64_t first, const int64_t last,
+                            const FillRule rule, const int64_t width, std::vector<drawing::Span>& out) {
+        std::vector<Edge> active;
+        size_t next = 0;
+
+        // Edges that started above the band enter it already under way
+        while (next < sources.size() && sources[next].top < first) {
+            if (sources[next].bottom > first) {
+                active.push_back(make_edge(sources[next], first));
+            }
+            ++next;
+        }
+
+        for (int64_t row = first; row < last; ++row) {
+            std::erase_if(active, [row](const Edge& edge) { return edge.bottom <= row; });
+            for (; next < sources.size() && sources[next].top == row; ++next) {
+                active.push_back(make_edge(sources[next], row));
+            }
+            if (active.empty()) {
+                if (next == sources.size()) {
+                    break;
+                }
+                row = std::min(sources[next].top, last) - 1;
+                continue;
+            }
+
+            // The order only changes where edges cross, so the list is nearly sorted already
+            for (size_t i = 1; i < active.size(); ++i) {
+                for (size_t j = i; j > 0 && active[j] < active[j - 1]; --j) {
+                    std::swap(active[j], active[j - 1]);
+                }
+            }
+
+            append_row(active, row, rule, width, out);
+            for (Edge& edge : active) {
+                edge.advance();
+            }
+        }
+    }
+
+public:
+    // The non-horizontal edges, sorted by top row
+    static EdgeTable make_edge_table(const std::span<const drawing::Point> vertices) {
+        for (const drawing::Point& vertex : vertices) {
+            if (vertex.x >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT ||
+                vertex.y >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT) {
+                throw std::out_of_range("Polygon vertex coordinates must stay within 2^30");
+            }
+        }
+
+        EdgeTable sources;
+        sources.reserve(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const drawing::Point& from = vertices[i];
+            const drawing::Point& to = vertices[(i + 1) % vertices.size()];
+            if (from.x == to.x) {
+                continue;   // horizontal edges cross no row centers
+            }
+            const bool down = from.x < to.x;
+            const drawing::Point& upper = down ? from : to;
+            const drawing::Point& lower = down ? to : from;
+            sources.push_back({
+                upper.x,
+                lower.x,
+                upper.y,
+                static_cast<int64_t>(lower.y) - upper.y,
+                static_cast<int8_t>(down ? 1 : -1)
+            });
+        }
+        std::sort(sources.begin(), sources.end(), [](const EdgeSource& a, const EdgeSource& b) {
+            return a.top < b.top;
+        });
+        return sources;
+    }
+
+    PolygonAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        std::vector<drawing::Point> vertices,
+        const FillRule rule = FillRule::NONZERO
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        vertices(std::move(vertices)),
+        rule(rule) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        spans.clear();
+        append_spans(vertices, rule, drawer->get_canvas_height(), drawer->get_canvas_width(), spans);
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Rows [first_row, last_row) of the polygon with the given edge table on the calling thread,
+    // for callers that split the canvas among threads themselves and build the table only once
+    static void append_rows(
+        const EdgeTable& edges,
+        const FillRule rule,
+        const int32_t first_row,
+        const int32_t last_row,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        append_band(edges, std::max(first_row, 0), last_row, rule, width, out);
+    }
+
+    // Appends the spans of the polygon that fall on a height x width canvas, row after row
+    static void append_spans(
+        const std::span<const drawing::Point> vertices,
+        const FillRule rule,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        const EdgeTable sources = make_edge_table(vertices);
+        if (sources.empty()) {
+            return;
+        }
+
+        int64_t first = sources.front().top;
+        int64_t last = 0;
+        for (const EdgeSource& source : sources) {
+            last = std::max(last, source.bottom);
+        }
+        first = std::max<int64_t>(first, 0);
+        last = std::min<int64_t>(last, height);
+        if (first >= last) {
+            return;
+        }
+
+        const int64_t band_height = std::max<int64_t>(64, (last - first + parallel::thread_count() - 1) / parallel::thread_count());
+        const int64_t bands = (last - first + band_height - 1) / band_height;
+        if (bands == 1) {
+            append_band(sources, first, last, rule, width, out);
+            return;
+        }
+
+        std::vector<std::vector<drawing::Span>> band_spans(bands);
+        parallel::for_each_range(0, bands, [&](const int64_t begin, const int64_t end) {
+            for (int64_t band = begin; band < end; ++band) {
+                append_band(sources, first + band * band_height, std::min(first + (band + 1) * band_height, last),
+                            rule, width, band_spans[band]);
+            }
+        });
+        for (const auto& band : band_spans) {
+            out.insert(out.end(), band.begin(), band.end());
+        }
+    }
+};
+
+}
+
+#endif
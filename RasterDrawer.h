@@ -2,7 +2,12 @@
 #define RASTER_DRAWER_H
 
 #include "BresenhamAlgorithmExecutor.h"
+#include "CurveAlgorithmExecutor.h"
+#include "EllipseAlgorithmExecutor.h"
 #include "FillingAlgorithmExecutor.h"
+#include "PolygonAlgorithmExecutor.h"
+#include "StrokeAlgorithmExecutor.h"
+#include "WuAlgorithmExecutor.h"
 
 
 class RasterDrawer {
@@ -42,11 +47,147 @@ public:
         delete executor;
     }
 
-    static void fill(const std::string& filename, const uint x, const uint y) {
+    static void draw_antialiased_line(const std::string& filename, const uint i0, const uint j0, const uint i1, const uint j1) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::WuLineAlgorithmExecutor{
+                drawer,
+                i0,
+                j0,
+                i1,
+                j1,
+                filename,
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    static void draw_antialiased_circle(const std::string& filename, const uint cx, const uint cy, const uint r) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::WuCircleAlgorithmExecutor{
+            drawer,
+            filename,
+            cx,
+            cy,
+            r
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    // Filled (or, with filled = false, outlined) ellipse written row span by row span; equal radii
+    // give a disk, the angle in radians rotates the column radius towards the rows
+    static void draw_ellipse(const std::string& filename, const uint cx, const uint cy, const uint row_radius,
+                             const uint column_radius, const double angle = 0.0, const bool filled = true) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::EllipseAlgorithmExecutor{
+            drawer,
+            filename,
+            cx,
+            cy,
+            row_radius,
+            column_radius,
+            angle,
+            filled
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    static void draw_disk(const std::string& filename, const uint cx, const uint cy, const uint r) {
+        draw_ellipse(filename, cx, cy, r, r);
+    }
+
+    // Quadratic Bezier curve for three control points, cubic for four
+    static void draw_bezier(const std::string& filename, std::vector<drawing::Point> controls) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::BezierAlgorithmExecutor{
+            drawer,
+            filename,
+            std::move(controls)
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    // Part of the circle from start_angle turning counterclockwise by sweep_angle, in radians
+    static void draw_arc(const std::string& filename, const uint cx, const uint cy, const uint r,
+                         const double start_angle, const double sweep_angle) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::ArcAlgorithmExecutor{
+            drawer,
+            filename,
+            cx,
+            cy,
+            r,
+            start_angle,
+            sweep_angle
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    static void fill_polygon(const std::string& filename, std::vector<drawing::Point> vertices,
+                             const curve_algorithms::FillRule rule = curve_algorithms::FillRule::NONZERO) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::PolygonAlgorithmExecutor{
+            drawer,
+            filename,
+            std::move(vertices),
+            rule
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    // Polyline of the given width, caps, joins and dashes, closed back to its first point on request
+    static void draw_stroke(const std::string& filename, std::vector<drawing::Point> points,
+                            curve_algorithms::StrokeStyle style, const bool closed = false) {
+        drawing::Drawer* drawer = new drawing::BmpDrawer();
+        curve_algorithms::BresenhamAlgorithmExecutor* executor =
+            new curve_algorithms::StrokeAlgorithmExecutor{
+            drawer,
+            filename,
+            std::move(points),
+            std::move(style),
+            closed
+        };
+
+        executor->execute();
+
+        delete drawer;
+        delete executor;
+    }
+
+    static void fill(const std::string& filename, const uint x, const uint y, const bool in_place = false) {
         const FillingAlgorithmExecutor executor(
             filename,
             x,
-            y
+            y,
+            in_place
         );
 
         executor.execute();
@@ -0,0 +1,182 @@
+#ifndef REORIENTATION_H
+#define REORIENTATION_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bmp {
+
+    // Flips, 90-degree rotations and transposition for 8, 24 and 32-bit images.
+    // Transposition walks 64x64 pixel blocks so both the rows read and the rows written
+    // stay in cache; inside a block 1- and 4-byte pixels are transposed in SSE registers.
+    // Rotations are transpositions of vertically flipped views, which cost nothing to create.
+    class Reorientation {
+        static constexpr int32_t BLOCK = 64;
+
+        static void check_view(const ConstImageView& view) {
+            if (view.bit_count != 8 && view.bit_count != 24 && view.bit_count != 32) {
+                throw std::runtime_error("Reorientation: only 8, 24 and 32-bit images are supported");
+            }
+        }
+
+        template<int BytesPerPixel>
+        static void transpose_scalar(const ConstImageView& src, const ImageView& dst,
+                                     const int32_t y0, const int32_t y1, const int32_t x0, const int32_t x1) {
+            for (int32_t x = x0; x < x1; ++x) {
+                uint8_t* out = dst.row(x) + y0 * BytesPerPixel;
+                for (int32_t y = y0; y < y1; ++y, out += BytesPerPixel) {
+                    std::memcpy(out, src.row(y) + x * BytesPerPixel, BytesPerPixel);
+                }
+            }
+        }
+
+#if defined(__SSE2__)
+        // Four rounds of the interleave r[i] x r[i + 8] form a perfect shuffle that transposes 16x16 bytes
+        static void transpose_16x16(const ConstImageView& src, const ImageView& dst, const int32_t y0, const int32_t x0) {
+            __m128i rows[16];
+            for (int i = 0; i < 16; ++i) {
+                rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.row(y0 + i) + x0));
+            }
+
+            for (int round = 0; round < 4; ++round) {
+                __m128i next[16];
+                for (int i = 0; i < 8; ++i) {
+                    next[2 * i] = _mm_unpacklo_epi8(rows[i], rows[i + 8]);
+                    next[2 * i + 1] = _mm_unpackhi_epi8(rows[i], rows[i + 8]);
+                }
+                std::copy_n(next, 16, rows);
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.row(x0 + i) + y0), rows[i]);
+            }
+        }
+
+        static void transpose_4x4(const ConstImageView& src, const ImageView& dst, const int32_t y0, const int32_t x0) {
+            const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.row(y0) + x0 * 4));
+            const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.row(y0 + 1) + x0 * 4));
+            const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.row(y0 + 2) + x0 * 4));
+            const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.row(y0 + 3) + x0 * 4));
+
+            const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+            const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+            const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+            const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.row(x0) + y0 * 4), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.row(x0 + 1) + y0 * 4), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.row(x0 + 2) + y0 * 4), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.row(x0 + 3) + y0 * 4), _mm_unpackhi_epi64(t2, t3));
+        }
+#endif
+
+        template<int BytesPerPixel>
+        static void transpose_block(const ConstImageView& src, const ImageView& dst,
+                                    const int32_t y0, const int32_t y1, const int32_t x0, const int32_t x1) {
+#if defined(__SSE2__)
+            constexpr int32_t tile = BytesPerPixel == 1 ? 16 : BytesPerPixel == 4 ? 4 : 0;
+            if constexpr (tile != 0) {
+                const int32_t full_y = y0 + (y1 - y0) / tile * tile;
+                const int32_t full_x = x0 + (x1 - x0) / tile * tile;
+
+                for (int32_t y = y0; y < full_y; y += tile) {
+                    for (int32_t x = x0; x < full_x; x += tile) {
+                        if constexpr (BytesPerPixel == 1) {
+                            transpose_16x16(src, dst, y, x);
+                        } else {
+                            transpose_4x4(src, dst, y, x);
+                        }
+                    }
+                }
+
+                transpose_scalar<BytesPerPixel>(src, dst, y0, y1, full_x, x1);
+                transpose_scalar<BytesPerPixel>(src, dst, full_y, y1, x0, full_x);
+                return;
+            }
+#endif
+            transpose_scalar<BytesPerPixel>(src, dst, y0, y1, x0, x1);
+        }
+
+        // Each thread owns a band of source columns, i.e. a band of destination rows
+        template<int BytesPerPixel>
+        static void transpose_blocked(const ConstImageView& src, const ImageView& dst) {
+            const int64_t column_blocks = (src.width + BLOCK - 1) / BLOCK;
+
+            parallel::for_each_range(0, column_blocks, [&](const int64_t first, const int64_t last) {
+                for (int64_t block = first; block < last; ++block) {
+                    const auto x0 = static_cast<int32_t>(block * BLOCK);
+                    const int32_t x1 = std::min(x0 + BLOCK, src.width);
+                    for (int32_t y0 = 0; y0 < src.height; y0 += BLOCK) {
+                        transpose_block<BytesPerPixel>(src, dst, y0, std::min(y0 + BLOCK, src.height), x0, x1);
+                    }
+                }
+            });
+        }
+
+    public:
+        // dst must be src.height x src.width with the same pixel format and must not overlap src
+        static void transpose(const ConstImageView& src, const ImageView& dst) {
+            check_view(src);
+            if (dst.width != src.height || dst.height != src.width || dst.bit_count != src.bit_count) {
+                throw std::invalid_argument("Reorientation: target geometry does not match the transposed source");
+            }
+
+            switch (src.bytes_per_pixel()) {
+                case 1:
+                    transpose_blocked<1>(src, dst);
+                    break;
+                case 3:
+                    transpose_blocked<3>(src, dst);
+                    break;
+                default:
+                    transpose_blocked<4>(src, dst);
+                    break;
+            }
+        }
+
+        static void rotate_90_clockwise(const ConstImageView& src, const ImageView& dst) {
+            transpose(src.flipped_vertically(), dst);
+        }
+
+        static void rotate_90_counterclockwise(const ConstImageView& src, const ImageView& dst) {
+            transpose(src, dst.flipped_vertically());
+        }
+
+        // In place: swaps whole rows from both ends towards the middle
+        static void flip_vertical(const ImageView& view) {
+            const size_t row_bytes = view.row_size_in_bytes();
+            for (int32_t top = 0, bottom = view.height - 1; top < bottom; ++top, --bottom) {
+                std::swap_ranges(view.row(top), view.row(top) + row_bytes, view.row(bottom));
+            }
+        }
+
+        // In place: reverses the pixel order of every row
+        static void flip_horizontal(const ImageView& view) {
+            check_view(view);
+            const int channels = view.bytes_per_pixel();
+
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    uint8_t* row = view.row(y);
+                    if (channels == 1) {
+                        std::reverse(row, row + view.width);
+                        continue;
+                    }
+                    for (int32_t left = 0, right = view.width - 1; left < right; ++left, --right) {
+                        std::swap_ranges(row + left * channels, row + (left + 1) * channels, row + right * channels);
+                    }
+                }
+            }, 16);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace bmp {
+
+    enum class ResampleFilter {
+        NEAREST,
+        BILINEAR,
+        AREA,
+        LANCZOS3
+    };
+
+    // Two-pass separable resize: a horizontal pass into an intermediate image of
+    // source height x target width, then a vertical pass. Taps are precomputed once per
+    // output column and per output row as 14-bit fixed-point weights.
+    class Resampler {
+        static constexpr int PRECISION = 14;
+        static constexpr int32_t ONE = 1 << PRECISION;
+
+        struct Coefficients {
+            int32_t taps {0};                   // maximum taps per output sample
+            std::vector<int32_t> first;         // first source index per output sample
+            std::vector<int32_t> count;         // taps actually used per output sample
+            std::vector<int16_t> weights;       // output samples x taps
+        };
+
+        static double filter_support(const ResampleFilter filter) {
+            switch (filter) {
+                case ResampleFilter::AREA:
+                    return 0.5;
+                case ResampleFilter::BILINEAR:
+                    return 1.0;
+                case ResampleFilter::LANCZOS3:
+                    return 3.0;
+                default:
+                    return 0.0;
+            }
+        }
+
+        static double sinc(const double x) {
+            if (x == 0.0) {
+                return 1.0;
+            }
+            const double pi_x = std::numbers::pi * x;
+            return std::sin(pi_x) / pi_x;
+        }
+
+        static double filter_weight(const ResampleFilter filter, double x) {
+            x = std::abs(x);
+            switch (filter) {
+                case ResampleFilter::AREA:
+                    return x < 0.5 ? 1.0 : 0.0;
+                case ResampleFilter::BILINEAR:
+                    return x < 1.0 ? 1.0 - x : 0.0;
+                case ResampleFilter::LANCZOS3:
+                    return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+                default:
+                    return 0.0;
+            }
+        }
+
+        // When shrinking, the filter is stretched by the scale so every source sample contributes
+        static Coefficients precompute(const ResampleFilter filter, const int32_t source_size, const int32_t target_size) {
+            const double scale = static_cast<double>(source_size) / target_size;
+            const double filter_scale = std::max(scale, 1.0);
+            const double support = filter_support(filter) * filter_scale;
+
+            Coefficients coefficients;
+            coefficients.taps = static_cast<int32_t>(std::ceil(support)) * 2 + 1;
+            coefficients.first.resize(target_size);
+            coefficients.count.resize(target_size);
+            coefficients.weights.assign(static_cast<size_t>(target_size) * coefficients.taps, 0);
+
+            std::vector<double> exact(coefficients.taps);
+            for (int32_t i = 0; i < target_size; ++i) {
+                const double center = (i + 0.5) * scale;
+                const auto first = std::max(0, static_cast<int32_t>(std::floor(center - support + 0.5)));
+                const auto last = std::min(source_size, static_cast<int32_t>(std::floor(center + support + 0.5)));
+                const int32_t count = std::clamp(last - first, 1, coefficients.taps);
+
+                double sum = 0.0;
+                for (int32_t k = 0; k < count; ++k) {
+                    exact[k] = filter_weight(filter, (first + k - center + 0.5) / filter_scale);
+                    sum += exact[k];
+                }
+
+                int16_t* weights = coefficients.weights.data() + static_cast<size_t>(i) * coefficients.taps;
+                int32_t quantized_sum = 0;
+                int32_t largest = 0;
+                for (int32_t k = 0; k < count; ++k) {
+                    const double normalized = sum != 0.0 ? exact[k] / sum : (k == 0 ? 1.0 : 0.0);
+                    weights[k] = static_cast<int16_t>(std::lround(normalized * ONE));
+                    quantized_sum += weights[k];
+                    if (weights[k] > weights[largest]) {
+                        largest = k;
+                    }
+                }
+                weights[largest] = static_cast<int16_t>(weights[largest] + ONE - quantized_sum);
+
+                coefficients.first[i] = std::min(first, source_size - count);
+                coefficients.count[i] = count;
+            }
+
+            return coefficients;
+        }
+
+        static uint8_t to_byte(const int32_t sum) {
+            return static_cast<uint8_t>(std::clamp((sum + (ONE >> 1)) >> PRECISION, 0, 255));
+        }
+
+        static void horizontal_pass(const ConstImageView& src, const ImageView& dst, const Coefficients& coefficients) {
+            const int channels = src.bytes_per_pixel();
+
+            parallel::for_each_range(0, src.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* in = src.row(y);
+                    uint8_t* out = dst.row(y);
+
+                    for (int32_t x = 0; x < dst.width; ++x) {
+                        const int16_t* weights = coefficients.weights.data() + static_cast<size_t>(x) * coefficients.taps;
+                        const uint8_t* source = in + coefficients.first[x] * channels;
+                        const int32_t count = coefficients.count[x];
+
+                        for (int c = 0; c < channels; ++c) {
+                            int32_t sum = 0;
+                            for (int32_t k = 0; k < count; ++k) {
+                                sum += weights[k] * source[k * channels + c];
+                            }
+                            out[x * channels + c] = to_byte(sum);
+                        }
+                    }
+                }
+            }, 16);
+        }
+
+        // Tap-outer, pixel-inner: each tap is a multiply-add across a whole row
+        static void vertical_pass(const ConstImageView& src, const ImageView& dst, const Coefficients& coefficients) {
+            const size_t row_bytes = dst.row_size_in_bytes();
+
+            parallel::for_each_range(0, dst.height, [&](const int64_t first, const int64_t last) {
+                std::vector<int32_t> sums(row_bytes);
+
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const int16_t* weights = coefficients.weights.data() + static_cast<size_t>(y) * coefficients.taps;
+                    std::fill(sums.begin(), sums.end(), 0);
+
+                    for (int32_t k = 0; k < coefficients.count[y]; ++k) {
+                        const int32_t weight = weights[k];
+                        const uint8_t* source = src.row(coefficients.first[y] + k);
+                        for (size_t i = 0; i < row_bytes; ++i) {
+                            sums[i] += weight * source[i];
+                        }
+                    }
+
+                    uint8_t* out = dst.row(y);
+                    for (size_t i = 0; i < row_bytes; ++i) {
+                        out[i] = to_byte(sums[i]);
+                    }
+                }
+            }, 16);
+        }
+
+        static void nearest(const ConstImageView& src, const ImageView& dst) {
+            const int channels = src.bytes_per_pixel();
+
+            std::vector<int32_t> columns(dst.width);
+            for (int32_t x = 0; x < dst.width; ++x) {
+                columns[x] = std::min(src.width - 1, static_cast<int32_t>((x + 0.5) * src.width / dst.width));
+            }
+
+            parallel::for_each_range(0, dst.height, [&](const int64_t first, const int64_t last) {
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const auto source_y = std::min(src.height - 1, static_cast<int32_t>((y + 0.5) * src.height / dst.height));
+                    const uint8_t* in = src.row(source_y);
+                    uint8_t* out = dst.row(y);
+
+                    for (int32_t x = 0; x < dst.width; ++x) {
+                        std::copy_n(in + columns[x] * channels, channels, out + x * channels);
+                    }
+                }
+            }, 16);
+        }
+
+    public:
+        // dst carries the target geometry and must not overlap src.
+        // 8-bit images are interpolated by palette index, which assumes a grayscale palette.
+        static void resize(const ConstImageView& src, const ImageView& dst, const ResampleFilter filter) {
+            if (src.bit_count != 8 && src.bit_count != 24 && src.bit_count != 32) {
+                throw std::runtime_error("Resampler: only 8, 24 and 32-bit images are supported");
+            }
+            if (src.bit_count != dst.bit_count) {
+                throw std::invalid_argument("Resampler: source and target pixel formats differ");
+            }
+            if (dst.width <= 0 || dst.height <= 0 || src.width <= 0 || src.height <= 0) {
+                throw std::invalid_argument("Resampler: image dimensions must be positive");
+            }
+
+            if (filter == ResampleFilter::NEAREST) {
+                nearest(src, dst);
+                return;
+            }
+
+            const Coefficients horizontal = precompute(filter, src.width, dst.width);
+            const Coefficients vertical = precompute(filter, src.height, dst.height);
+
+            const auto stride = static_cast<std::ptrdiff_t>((dst.row_size_in_bytes() + 3) & ~static_cast<size_t>(3));
+            std::vector<uint8_t> buffer(stride * src.height);
+            const ImageView intermediate {buffer.data(), dst.width, src.height, stride, src.bit_count};
+
+            horizontal_pass(src, intermediate, horizontal);
+            vertical_pass(intermediate, dst, vertical);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef STROKE_ALGORITHM_EXECUTOR_H
+#define STROKE_ALGORITHM_EXECUTOR_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace curve_algorithms {
+
+enum class LineCap {
+    BUTT,       // the stroke ends at the endpoint
+    ROUND,      // a half disk of the stroke's width past the endpoint
+    SQUARE      // half the width past the endpoint, squared off
+};
+
+enum class LineJoin {
+    MITER,      // outer edges extended until they meet, beveled past the miter limit
+    ROUND,      // a disk of the stroke's width around the vertex
+    BEVEL       // outer corners cut straight across
+};
+
+struct StrokeStyle {
+    double width {1.0};
+    LineCap cap {LineCap::BUTT};
+    LineJoin join {LineJoin::MITER};
+    // Longest miter allowed, as a multiple of the width, before a join is beveled instead
+    double miter_limit {4.0};
+    // Lengths of alternating dashes and gaps along the stroke, starting with a dash; an odd
+    // count is repeated once to make it even. Empty for a solid stroke
+    std::vector<double> dashes;
+    // How far into the dash pattern the stroke starts
+    double dash_offset {0.0};
+};
+
+// Wide strokes of polylines. Every segment becomes a quadrilateral around it, every cap and join a
+// disk or a convex polygon of its own; a pixel is covered when its center is inside one of these
+// pieces, with the top and left edges inclusive as in PolygonAlgorithmExecutor. The pieces of the
+// whole stroke are cut into row intervals which are then sorted and merged, so each pixel ends up
+// in exactly one span however many pieces overlap it and blending over a stroke stays correct.
+//
+// Points lie on pixel centers, x being the row and y the column as everywhere in drawing::Point.
+// Dashes are laid out along the polyline's length, every dash getting the stroke's caps at both
+// ends and its joins wherever it turns a vertex.
+class StrokeAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    std::vector<drawing::Point> points;
+    StrokeStyle style;
+    bool closed;
+
+    std::vector<drawing::Span> spans;
+
+    struct Vector {
+        double x;
+        double y;
+
+        Vector operator+(const Vector& other) const { return {x + other.x, y + other.y}; }
+        Vector operator-(const Vector& other) const { return {x - other.x, y - other.y}; }
+        Vector operator*(const double factor) const { return {x * factor, y * factor}; }
+
+        [[nodiscard]] double dot(const Vector& other) const { return x * other.x + y * other.y; }
+        [[nodiscard]] double cross(const Vector& other) const { return x * other.y - y * other.x; }
+        [[nodiscard]] double length() const { return std::hypot(x, y); }
+
+        [[nodiscard]] Vector normal() const { return {-y, x}; }
+    };
+
+    // Row intervals of the pieces, clipped to a height x width canvas, before they are merged
+    struct Pieces {
+        int32_t height;
+        int32_t width;
+        std::vector<drawing::Span>& out;
+
+        void add(const int64_t row, const double left, const double right) const {
+            const auto begin = static_cast<int64_t>(std::max(std::ceil(left), 0.0));
+            const auto end = static_cast<int64_t>(std::min(std::ceil(right), static_cast<double>(width)));
+            if (begin < end) {
+                out.push_back({static_cast<int32_t>(row), static_cast<int32_t>(begin), static_cast<int32_t>(end)});
+            }
+        }
+
+        [[nodiscard]] std::pair<int64_t, int64_t> rows(const double top, const double bottom) const {
+            return {static_cast<int64_t>(std::max(std::ceil(top), 0.0)),
+                    static_cast<int64_t>(std::min(std::ceil(bottom), static_cast<double>(height)))};
+        }
+
+        void disk(const Vector& center, const double radius) const {
+            const auto [first, last] = rows(center.x - radius, center.x + radius);
+            for (int64_t row = first; row < last; ++row) {
+                const double offset = static_cast<double>(row) - center.x;
+                const double half = std::sqrt(std::max(radius * radius - offset * offset, 0.0));
+                add(row, center.y - half, center.y + half);
+            }
+        }
+
+        void convex(const std::span<const Vector> polygon) const {
+            double top = polygon[0].x;
+            double bottom = polygon[0].x;
+            for (const Vector& vertex : polygon) {
+                top = std::min(top, vertex.x);
+                bottom = std::max(bottom, vertex.x);
+            }
+
+            const auto [first, last] = rows(top, bottom);
+            for (int64_t row = first; row < last; ++row) {
+                const auto center = static_cast<double>(row);
+                double left = INFINITY;
+                double right = -INFINITY;
+                for (size_t i = 0; i < polygon.size(); ++i) {
+                    const Vector& a = polygon[i];
+                    const Vector& b = polygon[(i + 1) % polygon.size()];
+                    if (a.x == b.x || center < std::min(a.x, b.x) || center > std::max(a.x, b.x)) {
+                        continue;
+                    }
+                    const double column = a.y + (center - a.x) * (b.y - a.y) / (b.x - a.x);
+                    left = std::min(left, column);
+                    right = std::max(right, column);
+                }
+                if (left < right) {
+                    add(row, left, right);
+                }
+            }
+        }
+    };
+
+    // Caps and body of segment from -> to of unit direction, d; start and end say which ends are
+    // ends of the stroke rather than joins
+    static void add_segment(const Pieces& pieces, const Vector& from, const Vector& to, const Vector& d,
+                            const bool start, const bool end, const StrokeStyle& style) {
+        const double half = style.width / 2;
+        const Vector side = d.normal() * half;
+        const Vector from_extended = start && style.cap == LineCap::SQUARE ? from - d * half : from;
+        const Vector to_extended = end && style.cap == LineCap::SQUARE ? to + d * half : to;
+        const Vector body[] {from_extended + side, to_extended + side, to_extended - side, from_extended - side};
+        pieces.convex(body);
+
+        if (style.cap == LineCap::ROUND) {
+            if (start) {
+                pieces.disk(from, half);
+            }
+            if (end) {
+                pieces.disk(to, half);
+            }
+        }
+    }
+
+    // Fills the wedge between the outer corners of two segments meeting at vertex with unit
+    // directions d0 in and d1 out
+    static void add_join(const Pieces& pieces, const Vector& vertex, const Vector& d0, const Vector& d1,
+                         const StrokeStyle& style) {
+        const double half = style.width / 2;
+        if (style.join == LineJoin::ROUND) {
+            pieces.disk(vertex, half);
+            return;
+        }
+
+        const double turn = d0.cross(d1);
+        if (turn == 0 && d0.dot(d1) > 0) {
+            return;
+        }
+        // The outer side is the one the path turns away from
+        const double outer = turn > 0 ? -1.0 : 1.0;
+        const Vector a = vertex + d0.normal() * (outer * half);
+        const Vector b = vertex + d1.normal() * (outer * half);
+
+        // The miter tip lies along the bisector of the normals, 1 / cos(turn / 2) half-widths away
+        const Vector bisector = d0.normal() + d1.normal();
+        const double bisector_length = bisector.length();
+        if (style.join == LineJoin::MITER && bisector_length > 0 && 2 / bisector_length <= style.miter_limit) {
+            const Vector tip = vertex + bisector * (outer * half * 2 / (bisector_length * bisector_length));
+            const Vector miter[] {vertex, a, tip, b};
+            pieces.convex(miter);
+            return;
+        }
+        const Vector bevel[] {vertex, a, b};
+        pieces.convex(bevel);
+    }
+
+    // One open or closed run of distinct points; direction is used when the run is a single point
+    static void add_polyline(const Pieces& pieces, const std::span<const Vector> path, const bool closed,
+                             const Vector& direction, const StrokeStyle& style) {
+        if (path.size() == 1) {
+            const double half = style.width / 2;
+            if (style.cap == LineCap::ROUND) {
+                pieces.disk(path[0], half);
+            } else if (style.cap == LineCap::SQUARE) {
+                const Vector along = direction * half;
+                const Vector side = direction.normal() * half;
+                const Vector square[] {path[0] - along + side, path[0] + along + side,
+                                       path[0] + along - side, path[0] - along - side};
+                pieces.convex(square);
+            }
+            return;
+        }
+
+        const size_t segments = closed ? path.size() : path.size() - 1;
+        const auto direction_of = [&](const size_t i) {
+            const Vector d = path[(i + 1) % path.size()] - path[i];
+            return d * (1 / d.length());
+        };
+        for (size_t i = 0; i < segments; ++i) {
+            const Vector d = direction_of(i);
+            add_segment(pieces, path[i], path[(i + 1) % path.size()], d, !closed && i == 0,
+                        !closed && i + 1 == segments, style);
+            if (closed || i + 1 < segments) {
+                add_join(pieces, path[(i + 1) % path.size()], d, direction_of((i + 1) % segments), style);
+            }
+        }
+    }
+
+    // Cuts the path into its dashes and adds each of them as an open polyline
+    static void add_dashes(const Pieces& pieces, const std::vector<Vector>& path, const bool closed,
+                           const StrokeStyle& style) {
+        std::vector<double> pattern = style.dashes;
+        if (pattern.size() % 2 == 1) {
+            pattern.insert(pattern.end(), style.dashes.begin(), style.dashes.end());
+        }
+        double period = 0;
+        for (const double length : pattern) {
+            if (!(length >= 0) || !std::isfinite(length)) {
+                throw std::invalid_argument("Dash lengths must be finite and non-negative");
+            }
+            period += length;
+        }
+        if (period <= 0) {
+            throw std::invalid_argument("A dash pattern must have a positive length");
+        }
+
+        // Position within the pattern: the current entry and how much of it is left
+        size_t entry = 0;
+        double offset = std::fmod(style.dash_offset, period);
+        if (offset < 0) {
+            offset += period;
+        }
+        for (size_t step = 0; step < pattern.size() && offset >= pattern[entry]; ++step) {
+            offset -= pattern[entry];
+            entry = (entry + 1) % pattern.size();
+        }
+        double left = std::max(pattern[entry] - offset, 0.0);
+
+        std::vector<Vector> dash;
+        Vector direction {0, 1};
+        const auto finish_dash = [&] {
+            if (!dash.empty()) {
+                add_polyline(pieces, dash, false, direction, style);
+                dash.clear();
+            }
+        };
+        const auto extend_dash = [&](const Vector& point) {
+            if (dash.empty() || dash.back().x != point.x || dash.back().y != point.y) {
+                dash.push_back(point);
+            }
+        };
+
+        const size_t segments = closed ? path.size() : path.size() - 1;
+        for (size_t i = 0; i < segments; ++i) {
+            const Vector from = path[i];
+            const Vector to = path[(i + 1) % path.size()];
+            const double length = (to - from).length();
+            direction = (to - from) * (1 / length);
+
+            double position = 0;
+            if (entry % 2 == 0) {
+                extend_dash(from);
+            }
+            while (position + left <= length) {
+                position += left;
+                const Vector point = from + direction * position;
+                extend_dash(point);
+                if (entry % 2 == 0) {
+                    finish_dash();
+                }
+                entry = (entry + 1) % pattern.size();
+                left = pattern[entry];
+            }
+            left -= length - position;
+            if (entry % 2 == 0) {
+                extend_dash(to);
+            }
+        }
+        finish_dash();
+    }
+
+public:
+    StrokeAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        std::vector<drawing::Point> points,
+        StrokeStyle style,
+        const bool closed = false
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        points(std::move(points)),
+        style(std::move(style)),
+        closed(closed) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        spans.clear();
+        append_spans(points, style, closed, drawer->get_canvas_height(), drawer->get_canvas_width(), spans);
+        drawer->draw(spans);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the stroke of the polyline through points (back to the first one when closed) that
+    // falls on a height x width canvas: disjoint spans sorted by row and column
+    static void append_spans(
+        const std::span<const drawing::Point> points,
+        const StrokeStyle& style,
+        const bool closed,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Span>& out
+    ) {
+        if (!(style.width > 0) || !std::isfinite(style.width)) {
+            throw std::invalid_argument("Stroke width must be positive");
+        }
+        if (!(style.miter_limit >= 1)) {
+            throw std::invalid_argument("Miter limit must be at least 1");
+        }
+
+        std::vector<Vector> path;
+        path.reserve(points.size());
+        for (const drawing::Point& point : points) {
+            if (point.x >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT ||
+                point.y >= LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT) {
+                throw std::out_of_range("Stroke point coordinates must stay within 2^30");
+            }
+            const Vector vector {static_cast<double>(point.x), static_cast<double>(point.y)};
+            if (path.empty() || path.back().x != vector.x || path.back().y != vector.y) {
+                path.push_back(vector);
+            }
+        }
+        while (closed && path.size() > 1 && path.back().x == path.front().x && path.back().y == path.front().y) {
+            path.pop_back();
+        }
+        if (path.empty()) {
+            return;
+        }
+
+        const size_t first_new = out.size();
+        const Pieces pieces {height, width, out};
+        if (style.dashes.empty() || path.size() == 1) {
+            add_polyline(pieces, path, closed && path.size() > 2, Vector {0, 1}, style);
+        } else {
+            add_dashes(pieces, path, closed, style);
+        }
+
+        // Overlapping pieces are merged, so no pixel is written twice
+        merge_spans(out, first_new);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef THRESHOLDING_H
+#define THRESHOLDING_H
+
+#include "BmpConverter.h"
+#include "ImageStatistics.h"
+#include "ImageView.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace bmp {
+
+    enum class ThresholdMethod {
+        OTSU,       // maximal between-class variance
+        TRIANGLE,   // farthest bin from the line between the histogram peak and its longer tail
+        KAPUR       // maximal sum of the entropies of both classes
+    };
+
+    using Histogram = std::array<uint64_t, 256>;
+
+    // Picks a threshold p from a 256-bin histogram in O(256). The result follows to_monochrome:
+    // values >= p become white, so p is one past the last value of the dark class.
+    class ThresholdSelector {
+        static int otsu(const Histogram& histogram) {
+            double total = 0.0;
+            double total_sum = 0.0;
+            for (int i = 0; i < 256; ++i) {
+                total += static_cast<double>(histogram[i]);
+                total_sum += static_cast<double>(histogram[i]) * i;
+            }
+
+            double weight_dark = 0.0;
+            double sum_dark = 0.0;
+            double best_variance = -1.0;
+            int best = 0;
+
+            for (int t = 0; t < 255; ++t) {
+                weight_dark += static_cast<double>(histogram[t]);
+                sum_dark += static_cast<double>(histogram[t]) * t;
+                const double weight_bright = total - weight_dark;
+                if (weight_dark == 0.0 || weight_bright == 0.0) {
+                    continue;
+                }
+
+                const double mean_difference = sum_dark / weight_dark - (total_sum - sum_dark) / weight_bright;
+                const double variance = weight_dark * weight_bright * mean_difference * mean_difference;
+                if (variance > best_variance) {
+                    best_variance = variance;
+                    best = t;
+                }
+            }
+            return best + 1;
+        }
+
+        static int triangle(const Histogram& histogram) {
+            int first = 0;
+            while (first < 255 && histogram[first] == 0) {
+                ++first;
+            }
+            int last = 255;
+            while (last > 0 && histogram[last] == 0) {
+                --last;
+            }
+            int peak = first;
+            for (int i = first; i <= last; ++i) {
+                if (histogram[i] > histogram[peak]) {
+                    peak = i;
+                }
+            }
+
+            // The line runs from the peak to the first empty bin past the longer tail
+            const bool tail_is_bright = last - peak > peak - first;
+            const int end = tail_is_bright ? std::min(last + 1, 255) : std::max(first - 1, 0);
+            const auto peak_height = static_cast<double>(histogram[peak]);
+
+            int best = peak;
+            double best_distance = -1.0;
+            const int step = tail_is_bright ? 1 : -1;
+            for (int i = peak; i != end; i += step) {
+                // Unnormalized distance from (i, h[i]) to the line through (peak, h[peak]) and (end, 0)
+                const double distance = peak_height * (end - i) / (end - peak) - static_cast<double>(histogram[i]);
+                if (distance > best_distance) {
+                    best_distance = distance;
+                    best = i;
+                }
+            }
+            return tail_is_bright ? best : best + 1;
+        }
+
+        static int kapur(const Histogram& histogram) {
+            double total = 0.0;
+            for (const auto count : histogram) {
+                total += static_cast<double>(count);
+            }
+            if (total == 0.0) {
+                return 128;
+            }
+
+            // Class entropy: H = ln(P) - sum(p ln p) / P, with running sums from both ends
+            std::array<double, 256> p_log_p {};
+            double all_p_log_p = 0.0;
+            for (int i = 0; i < 256; ++i) {
+                const double p = static_cast<double>(histogram[i]) / total;
+                p_log_p[i] = p > 0.0 ? p * std::log(p) : 0.0;
+                all_p_log_p += p_log_p[i];
+            }
+
+            double mass_dark = 0.0;
+            double p_log_p_dark = 0.0;
+            double best_entropy = -std::numeric_limits<double>::infinity();
+            int best = 0;
+
+            for (int t = 0; t < 255; ++t) {
+                mass_dark += static_cast<double>(histogram[t]) / total;
+                p_log_p_dark += p_log_p[t];
+                const double mass_bright = 1.0 - mass_dark;
+                if (mass_dark <= 0.0 || mass_bright <= 1e-12) {
+                    continue;
+                }
+
+                const double entropy = std::log(mass_dark) - p_log_p_dark / mass_dark +
+                    std::log(mass_bright) - (all_p_log_p - p_log_p_dark) / mass_bright;
+                if (entropy > best_entropy) {
+                    best_entropy = entropy;
+                    best = t;
+                }
+            }
+            return best + 1;
+        }
+
+    public:
+        static int select(const Histogram& histogram, const ThresholdMethod method) {
+            switch (method) {
+                case ThresholdMethod::OTSU:
+                    return otsu(histogram);
+                case ThresholdMethod::TRIANGLE:
+                    return triangle(histogram);
+                case ThresholdMethod::KAPUR:
+                    return kapur(histogram);
+            }
+            throw std::invalid_argument("ThresholdSelector: unknown method");
+        }
+
+        // Histogram of the value each pixel is thresholded on: the palette index of 8-bit images,
+        // or the same luminance BmpConverterRgbToMonochrome compares for 24-bit ones
+        static Histogram gray_histogram(const ConstImageView& view) {
+            if (view.bit_count == 8) {
+                return ImageStatistics::compute(view).channels[0].histogram;
+            }
+            if (view.bit_count != 24) {
+                throw std::runtime_error("ThresholdSelector: only 8 and 24-bit images can be thresholded");
+            }
+
+            Histogram histogram {};
+            std::mutex merge_mutex;
+
+            parallel::for_each_range(0, view.height, [&](const int64_t first, const int64_t last) {
+                std::array<uint32_t, 256> local {};
+                for (auto y = static_cast<int32_t>(first); y < last; ++y) {
+                    const uint8_t* pixel = view.row(y);
+                    for (int32_t x = 0; x < view.width; ++x, pixel += 3) {
+                        ++local[luminance(pixel[0], pixel[1], pixel[2])];
+                    }
+                }
+
+                const std::lock_guard lock(merge_mutex);
+                for (int i = 0; i < 256; ++i) {
+                    histogram[i] += local[i];
+                }
+            }, 64);
+
+            return histogram;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef WU_ALGORITHM_EXECUTOR_H
+#define WU_ALGORITHM_EXECUTOR_H
+
+#include "BresenhamAlgorithmExecutor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace curve_algorithms {
+
+// Xiaolin Wu's anti-aliased segment. Every major-axis step touches the two pixels straddling the
+// exact minor position and splits full coverage between them by its fractional part, kept as a
+// 32.32 fixed-point accumulator so no step divides or touches floating point.
+class WuLineAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    uint32_t i0;
+    uint32_t i1;
+    uint32_t j0;
+    uint32_t j1;
+
+    std::vector<drawing::Coverage> pixels;
+
+    static constexpr int FRACTION_BITS = 32;
+
+public:
+    WuLineAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        const uint32_t i0,
+        const uint32_t j0,
+        const uint32_t i1,
+        const uint32_t j1,
+        std::string filename
+    ) : BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)), i0(i0), i1(i1), j0(j0), j1(j1) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        pixels.clear();
+        append_coverage(
+            static_cast<int32_t>(i0), static_cast<int32_t>(j0),
+            static_cast<int32_t>(i1), static_cast<int32_t>(j1),
+            drawer->get_canvas_height(), drawer->get_canvas_width(),
+            pixels
+        );
+        drawer->draw(pixels);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the covered pixels of the segment from (i0, j0) up to, but excluding, (i1, j1) that
+    // fall on a height x width canvas, with the same endpoint convention and coordinate limits as
+    // LineSegmentBresenhamAlgorithmExecutor::append_spans. Each pixel is listed once.
+    static void append_coverage(
+        const int32_t i0,
+        const int32_t j0,
+        const int32_t i1,
+        const int32_t j1,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Coverage>& out
+    ) {
+        constexpr int64_t LIMIT = LineSegmentBresenhamAlgorithmExecutor::COORDINATE_LIMIT;
+        for (const int32_t coordinate : {i0, j0, i1, j1}) {
+            if (coordinate <= -LIMIT || coordinate >= LIMIT) {
+                throw std::out_of_range("Line endpoint coordinates must stay within 2^30");
+            }
+        }
+
+        const bool major_is_row = std::abs(static_cast<int64_t>(j1) - j0) <= std::abs(static_cast<int64_t>(i1) - i0);
+        const int64_t a0 = major_is_row ? i0 : j0;
+        const int64_t b0 = major_is_row ? j0 : i0;
+        const int64_t a_extent = major_is_row ? height : width;
+        const int64_t b_extent = major_is_row ? width : height;
+        const int64_t d_a = (major_is_row ? static_cast<int64_t>(i1) : j1) - a0;
+        const int64_t d_b = (major_is_row ? static_cast<int64_t>(j1) : i1) - b0;
+        const int8_t s_a = d_a < 0 ? -1 : 1;
+        const int8_t s_b = d_b < 0 ? -1 : 1;
+        const auto length = static_cast<uint64_t>(std::abs(d_a));
+        const auto d_minor = static_cast<uint64_t>(std::abs(d_b));
+
+        if (length == 0) {
+            return;
+        }
+
+        // Minor offset of step k is (k * gradient) >> 32; d_minor <= length keeps it within 2^32
+        const uint64_t gradient = (d_minor << FRACTION_BITS) / length;
+
+        int64_t k_first = 0;
+        int64_t k_last = static_cast<int64_t>(length) - 1;
+        if (s_a > 0) {
+            k_first = std::max(k_first, -a0);
+            k_last = std::min(k_last, a_extent - 1 - a0);
+        } else {
+            k_first = std::max(k_first, a0 - (a_extent - 1));
+            k_last = std::min(k_last, a0);
+        }
+
+        // A step is visible while either of its pixels, m and m + 1, lies on the canvas
+        const int64_t m_low = (s_b > 0 ? -b0 : b0 - (b_extent - 1)) - 1;
+        const int64_t m_high = s_b > 0 ? b_extent - 1 - b0 : b0;
+        if (m_high < 0 || m_low > static_cast<int64_t>(d_minor)) {
+            return;
+        }
+        if (gradient == 0) {
+            if (m_low > 0) {
+                return;
+            }
+        } else {
+            if (m_low > 0) {
+                const uint64_t target = static_cast<uint64_t>(m_low) << FRACTION_BITS;
+                k_first = std::max(k_first, static_cast<int64_t>((target + gradient - 1) / gradient));
+            }
+            const uint64_t bound = (static_cast<uint64_t>(m_high) + 1) << FRACTION_BITS;
+            k_last = std::min(k_last, static_cast<int64_t>((bound - 1) / gradient));
+        }
+
+        if (k_first > k_last) {
+            return;
+        }
+
+        out.reserve(out.size() + 2 * static_cast<size_t>(k_last - k_first + 1));
+        uint64_t position = static_cast<uint64_t>(k_first) * gradient;
+        for (int64_t k = k_first; k <= k_last; ++k, position += gradient) {
+            const auto major = static_cast<int32_t>(a0 + s_a * k);
+            const auto m = static_cast<int64_t>(position >> FRACTION_BITS);
+            const auto weight = static_cast<uint8_t>(position >> (FRACTION_BITS - 8));
+            const auto near = static_cast<int32_t>(b0 + s_b * m);
+            const auto far = near + s_b;
+
+            if (near >= 0 && near < b_extent) {
+                out.push_back(major_is_row
+                    ? drawing::Coverage {major, near, static_cast<uint8_t>(255 - weight)}
+                    : drawing::Coverage {near, major, static_cast<uint8_t>(255 - weight)});
+            }
+            if (weight != 0 && far >= 0 && far < b_extent) {
+                out.push_back(major_is_row
+                    ? drawing::Coverage {major, far, weight}
+                    : drawing::Coverage {far, major, weight});
+            }
+        }
+    }
+};
+
+// Wu's anti-aliased circle: for every column offset x of one octant the exact height
+// sqrt(r^2 - x^2) is taken in 8.8 fixed point, with r^2 - x^2 kept up to date by differences,
+// and split between the two pixels around it. The eight mirrored octants are merged so that
+// pixels on the diagonals and axes are blended only once.
+class WuCircleAlgorithmExecutor final : public BresenhamAlgorithmExecutorWithFile {
+    uint32_t cx;
+    uint32_t cy;
+    uint32_t r;
+
+    std::vector<drawing::Coverage> pixels;
+
+    // floor(sqrt(value)), exact for every value below 2^62
+    static uint64_t isqrt(const uint64_t value) {
+        auto root = static_cast<uint64_t>(std::sqrt(static_cast<double>(value)));
+        while (root * root > value) {
+            --root;
+        }
+        while ((root + 1) * (root + 1) <= value) {
+            ++root;
+        }
+        return root;
+    }
+
+public:
+    WuCircleAlgorithmExecutor(
+        drawing::Drawer* drawer,
+        std::string filename,
+        const uint32_t cx,
+        const uint32_t cy,
+        const uint32_t r
+    ) :
+        BresenhamAlgorithmExecutorWithFile(drawer, std::move(filename)),
+        cx(cx),
+        cy(cy),
+        r(r) {}
+
+    void execute() override {
+        rasterize();
+        save();
+    }
+
+    void rasterize() override {
+        pixels.clear();
+        append_coverage(static_cast<int32_t>(cx), static_cast<int32_t>(cy), r,
+                        drawer->get_canvas_height(), drawer->get_canvas_width(), pixels);
+        drawer->draw(pixels);
+    }
+
+    void save() override {
+        drawer->save(filename);
+    }
+
+    // Appends the covered pixels of the circle around row cx, column cy that fall on a
+    // height x width canvas, sorted by row and column
+    static void append_coverage(
+        const int32_t cx,
+        const int32_t cy,
+        const uint32_t r,
+        const int32_t height,
+        const int32_t width,
+        std::vector<drawing::Coverage>& out
+    ) {
+        constexpr uint32_t RADIUS_LIMIT = uint32_t {1} << 22;
+        if (r >= RADIUS_LIMIT) {
+            throw std::out_of_range("Circle radius must stay below 2^22");
+        }
+        const int64_t reach = static_cast<int64_t>(r) + 1;
+        if (cx + reach < 0 || cx - reach >= height || cy + reach < 0 || cy - reach >= width) {
+            return;
+        }
+
+        const size_t first_new = out.size();
+        const auto put = [&](const int64_t row, const int64_t column, const uint8_t alpha) {
+            if (alpha != 0 && row >= 0 && row < height && column >= 0 && column < width) {
+                out.push_back({static_cast<int32_t>(row), static_cast<int32_t>(column), alpha});
+            }
+        };
+
+        // remaining = r^2 - x^2, y = sqrt(remaining) as 8.8 fixed point
+        uint64_t remaining = static_cast<uint64_t>(r) * r;
+        for (int64_t x = 0;; ++x) {
+            const uint64_t y = isqrt(remaining << 16);
+            const auto inner = static_cast<int64_t>(y >> 8);
+            if (x > inner) {
+                break;
+            }
+            const auto weight = static_cast<uint8_t>(y);
+
+            for (const auto& [u, v, alpha] : {std::tuple {x, inner, static_cast<uint8_t>(255 - weight)},
+                                             std::tuple {x, inner + 1, weight}}) {
+                put(cx + u, cy + v, alpha);
+                put(cx - u, cy + v, alpha);
+                put(cx + u, cy - v, alpha);
+                put(cx - u, cy - v, alpha);
+                put(cx + v, cy + u, alpha);
+                put(cx - v, cy + u, alpha);
+                put(cx + v, cy - u, alpha);
+                put(cx - v, cy - u, alpha);
+            }
+            if (remaining < static_cast<uint64_t>(2 * x + 1)) {
+                break;
+            }
+            remaining -= 2 * x + 1;
+        }
+
+        // Mirrors coincide on the axes and the diagonals; the strongest coverage wins
+        const auto begin = out.begin() + static_cast<std::ptrdiff_t>(first_new);
+        std::sort(begin, out.end(), [](const drawing::Coverage& a, const drawing::Coverage& b) {
+            return a.row < b.row || (a.row == b.row && (a.column < b.column || (a.column == b.column && a.alpha > b.alpha)));
+        });
+        out.erase(std::unique(begin, out.end(), [](const drawing::Coverage& a, const drawing::Coverage& b) {
+            return a.row == b.row && a.column == b.column;
+        }), out.end());
+    }
+};
+
+}
+
+#endif
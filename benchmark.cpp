@@ -0,0 +1,291 @@
+#include "BresenhamAlgorithmExecutor.h"
+#include "CurveAlgorithmExecutor.h"
+#include "DisplayList.h"
+#include "Drawer.h"
+#include "StrokeAlgorithmExecutor.h"
+#include "WuAlgorithmExecutor.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct Segment {
+    int32_t i0;
+    int32_t j0;
+    int32_t i1;
+    int32_t j1;
+};
+
+// Short segments scattered over the canvas and a margin around it, so some of them get clipped
+std::vector<Segment> make_segments(const size_t count, const int32_t height, const int32_t width, const int32_t max_length) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int32_t> row(-max_length, height + max_length);
+    std::uniform_int_distribution<int32_t> column(-max_length, width + max_length);
+    std::uniform_int_distribution<int32_t> offset(-max_length, max_length);
+
+    std::vector<Segment> segments(count);
+    for (auto& segment : segments) {
+        segment.i0 = row(generator);
+        segment.j0 = column(generator);
+        segment.i1 = segment.i0 + offset(generator);
+        segment.j1 = segment.j0 + offset(generator);
+    }
+    return segments;
+}
+
+template<typename Function>
+double seconds(Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& name, const size_t lines, const double elapsed) {
+    std::cout << name << ": " << lines << " lines in " << elapsed * 1000.0 << " ms, "
+              << static_cast<double>(lines) / elapsed / 1e6 << " M lines/s" << std::endl;
+}
+
+int main() {
+    drawing::BmpDrawer drawer;
+    const int32_t height = drawer.get_canvas_height();
+    const int32_t width = drawer.get_canvas_width();
+
+    constexpr size_t LINES = 10'000'000;
+    constexpr size_t PER_PIXEL_LINES = 1'000'000;
+    constexpr size_t FLUSH_SPANS = 1 << 16;
+    const auto segments = make_segments(LINES, height, width, 16);
+
+    // Clipped run-slice rasterization, spans handed to the drawer in large batches
+    std::vector<drawing::Span> spans;
+    spans.reserve(FLUSH_SPANS + 64);
+    const double batched = seconds([&] {
+        for (const auto& segment : segments) {
+            curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                segment.i0, segment.j0, segment.i1, segment.j1, height, width, spans);
+            if (spans.size() >= FLUSH_SPANS) {
+                drawer.draw(spans);
+                spans.clear();
+            }
+        }
+        drawer.draw(spans);
+        spans.clear();
+    });
+    report("run-slice spans, batched", LINES, batched);
+
+    // The same pixels pushed one virtual call at a time
+    const double per_pixel = seconds([&] {
+        std::vector<drawing::Span> line;
+        for (size_t n = 0; n < PER_PIXEL_LINES; ++n) {
+            const auto& segment = segments[n];
+            line.clear();
+            curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                segment.i0, segment.j0, segment.i1, segment.j1, height, width, line);
+            for (const auto& span : line) {
+                for (int32_t column = span.begin; column < span.end; ++column) {
+                    drawer.draw(drawing::Point(span.row, column));
+                }
+            }
+        }
+    });
+    report("single points", PER_PIXEL_LINES, per_pixel);
+
+    drawer.save("benchmark_lines.bmp");
+
+    // Anti-aliasing: Wu coverage against 4x supersampling (2 x 2 samples per pixel), both blended
+    // through the same coverage path
+    constexpr size_t AA_LINES = 2'000'000;
+    drawing::BmpDrawer wu_drawer;
+    std::vector<drawing::Coverage> pixels;
+    pixels.reserve(FLUSH_SPANS + 256);
+    const double wu = seconds([&] {
+        for (size_t n = 0; n < AA_LINES; ++n) {
+            const auto& segment = segments[n];
+            curve_algorithms::WuLineAlgorithmExecutor::append_coverage(
+                segment.i0, segment.j0, segment.i1, segment.j1, height, width, pixels);
+            if (pixels.size() >= FLUSH_SPANS) {
+                wu_drawer.draw(pixels);
+                pixels.clear();
+            }
+        }
+        wu_drawer.draw(pixels);
+        pixels.clear();
+    });
+    report("Wu coverage", AA_LINES, wu);
+    wu_drawer.save("benchmark_wu.bmp");
+
+    drawing::BmpDrawer supersampled_drawer;
+    std::vector<uint8_t> samples(static_cast<size_t>(height) * width, 0);
+    std::vector<size_t> touched;
+    const double supersampled = seconds([&] {
+        for (size_t n = 0; n < AA_LINES; ++n) {
+            const auto& segment = segments[n];
+            spans.clear();
+            curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                2 * segment.i0, 2 * segment.j0, 2 * segment.i1, 2 * segment.j1, 2 * height, 2 * width, spans);
+            for (const auto& span : spans) {
+                for (int32_t column = span.begin; column < span.end; ++column) {
+                    const size_t index = static_cast<size_t>(span.row / 2) * width + column / 2;
+                    if (samples[index]++ == 0) {
+                        touched.push_back(index);
+                    }
+                }
+            }
+            for (const size_t index : touched) {
+                pixels.push_back({static_cast<int32_t>(index / width), static_cast<int32_t>(index % width),
+                                  static_cast<uint8_t>(std::min(samples[index] * 64, 255))});
+                samples[index] = 0;
+            }
+            touched.clear();
+            if (pixels.size() >= FLUSH_SPANS) {
+                supersampled_drawer.draw(pixels);
+                pixels.clear();
+            }
+        }
+        supersampled_drawer.draw(pixels);
+        pixels.clear();
+    });
+    report("4x supersampling", AA_LINES, supersampled);
+    supersampled_drawer.save("benchmark_supersampled.bmp");
+
+    // Wide lines: one merged stroke against the same width made of offset 1-pixel lines
+    constexpr size_t WIDE_LINES = 200'000;
+    constexpr int32_t LINE_WIDTH = 8;
+    curve_algorithms::StrokeStyle style;
+    style.width = LINE_WIDTH;
+    style.cap = curve_algorithms::LineCap::ROUND;
+    drawing::BmpDrawer stroke_drawer;
+    const double stroked = seconds([&] {
+        for (size_t n = 0; n < WIDE_LINES; ++n) {
+            const auto& segment = segments[n];
+            const drawing::Point ends[] {drawing::Point(std::max(segment.i0, 0), std::max(segment.j0, 0)),
+                                         drawing::Point(std::max(segment.i1, 0), std::max(segment.j1, 0))};
+            curve_algorithms::StrokeAlgorithmExecutor::append_spans(ends, style, false, height, width, spans);
+            if (spans.size() >= FLUSH_SPANS) {
+                stroke_drawer.draw(spans);
+                spans.clear();
+            }
+        }
+        stroke_drawer.draw(spans);
+        spans.clear();
+    });
+    report("8-pixel strokes", WIDE_LINES, stroked);
+    stroke_drawer.save("benchmark_strokes.bmp");
+
+    drawing::BmpDrawer offset_drawer;
+    const double offset_lines = seconds([&] {
+        for (size_t n = 0; n < WIDE_LINES; ++n) {
+            const auto& segment = segments[n];
+            for (int32_t offset = -LINE_WIDTH / 2; offset < LINE_WIDTH / 2; ++offset) {
+                curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                    segment.i0 + offset, segment.j0, segment.i1 + offset, segment.j1, height, width, spans);
+                curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(
+                    segment.i0, segment.j0 + offset, segment.i1, segment.j1 + offset, height, width, spans);
+            }
+            if (spans.size() >= FLUSH_SPANS) {
+                offset_drawer.draw(spans);
+                spans.clear();
+            }
+        }
+        offset_drawer.draw(spans);
+        spans.clear();
+    });
+    report("8 offset lines per axis", WIDE_LINES, offset_lines);
+    offset_drawer.save("benchmark_offset_lines.bmp");
+
+    // Cubic curves: adaptive forward differencing against 256 pre-sampled segments per curve
+    constexpr size_t CURVES = 20'000;
+    constexpr int SAMPLES = 256;
+    const auto curve_segments = make_segments(2 * CURVES, height, width, 200);
+    const auto controls_of = [&](const size_t n) {
+        const auto& first = curve_segments[2 * n];
+        const auto& second = curve_segments[2 * n + 1];
+        return std::array {drawing::Point(std::max(first.i0, 0), std::max(first.j0, 0)),
+                           drawing::Point(std::max(first.i1, 0), std::max(first.j1, 0)),
+                           drawing::Point(std::max(second.i0, 0), std::max(second.j0, 0)),
+                           drawing::Point(std::max(second.i1, 0), std::max(second.j1, 0))};
+    };
+    drawing::BmpDrawer bezier_drawer;
+    const double differenced = seconds([&] {
+        for (size_t n = 0; n < CURVES; ++n) {
+            curve_algorithms::BezierAlgorithmExecutor::append_spans(controls_of(n), height, width, spans);
+            if (spans.size() >= FLUSH_SPANS) {
+                bezier_drawer.draw(spans);
+                spans.clear();
+            }
+        }
+        bezier_drawer.draw(spans);
+        spans.clear();
+    });
+    report("Bezier forward differencing", CURVES, differenced);
+    bezier_drawer.save("benchmark_bezier.bmp");
+
+    drawing::BmpDrawer sampled_drawer;
+    const double sampled = seconds([&] {
+        for (size_t n = 0; n < CURVES; ++n) {
+            const auto controls = controls_of(n);
+            int32_t i0 = static_cast<int32_t>(controls[0].x);
+            int32_t j0 = static_cast<int32_t>(controls[0].y);
+            for (int k = 1; k <= SAMPLES; ++k) {
+                const double t = static_cast<double>(k) / SAMPLES;
+                const double u = 1 - t;
+                const double w[] {u * u * u, 3 * t * u * u, 3 * t * t * u, t * t * t};
+                double i = 0;
+                double j = 0;
+                for (int c = 0; c < 4; ++c) {
+                    i += w[c] * controls[c].x;
+                    j += w[c] * controls[c].y;
+                }
+                const auto i1 = static_cast<int32_t>(std::lround(i));
+                const auto j1 = static_cast<int32_t>(std::lround(j));
+                curve_algorithms::LineSegmentBresenhamAlgorithmExecutor::append_spans(i0, j0, i1, j1, height, width, spans);
+                i0 = i1;
+                j0 = j1;
+            }
+            if (spans.size() >= FLUSH_SPANS) {
+                sampled_drawer.draw(spans);
+                spans.clear();
+            }
+        }
+        sampled_drawer.draw(spans);
+        spans.clear();
+    });
+    report("Bezier, 256 sampled segments", CURVES, sampled);
+    sampled_drawer.save("benchmark_bezier_sampled.bmp");
+
+    // A typical job: 50k mixed primitives recorded on one canvas, drawn band by band on flush
+    constexpr size_t PRIMITIVES = 50'000;
+    drawing::BmpDrawer list_drawer;
+    drawing::DisplayList list(list_drawer);
+    const double recorded = seconds([&] {
+        for (size_t n = 0; n < PRIMITIVES; ++n) {
+            const auto& segment = segments[n];
+            switch (n % 5) {
+                case 0:
+                    list.line(segment.i0, segment.j0, segment.i1, segment.j1);
+                    break;
+                case 1:
+                    list.antialiased_line(segment.i0, segment.j0, segment.i1, segment.j1);
+                    break;
+                case 2:
+                    list.circle(segment.i0, segment.j0, std::abs(segment.i1 - segment.i0));
+                    break;
+                case 3:
+                    list.ellipse(segment.i0, segment.j0, std::abs(segment.i1 - segment.i0), std::abs(segment.j1 - segment.j0));
+                    break;
+                default:
+                    list.polygon({drawing::Point(std::max(segment.i0, 0), std::max(segment.j0, 0)),
+                                  drawing::Point(std::max(segment.i1, 0), std::max(segment.j0, 0)),
+                                  drawing::Point(std::max(segment.i0, 0), std::max(segment.j1, 0))});
+                    break;
+            }
+        }
+        list.flush();
+    });
+    std::cout << "display list: " << PRIMITIVES << " primitives in " << recorded * 1000.0 << " ms on "
+              << parallel::thread_count() << " threads" << std::endl;
+    list_drawer.save("benchmark_display_list.bmp");
+    return 0;
+}
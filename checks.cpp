@@ -0,0 +1,211 @@
+#include "Bmp.h"
+#include "CurveAlgorithmExecutor.h"
+#include "Drawer.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numbers>
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+void check(const bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+bool contains(const std::vector<drawing::Span>& spans, const int32_t row, const int32_t column) {
+    for (const auto& span : spans) {
+        if (span.row == row && span.begin <= column && column < span.end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Both ends of quarter and half arcs lie on the axes, where the sines and cosines of the angles
+// are off by an ulp; the end pixels must still be drawn
+void check_arc_ends() {
+    constexpr double PI = std::numbers::pi;
+    constexpr int32_t CX = 50;
+    constexpr int32_t CY = 50;
+    constexpr int32_t R = 20;
+
+    struct Case {
+        double start;
+        double sweep;
+        int32_t start_row, start_column;
+        int32_t end_row, end_column;
+    };
+    const Case cases[] {
+        {0, PI / 2, CX, CY + R, CX - R, CY},
+        {0, -PI / 2, CX, CY + R, CX + R, CY},
+        {PI / 2, PI / 2, CX - R, CY, CX, CY - R},
+        {PI, PI / 2, CX, CY - R, CX + R, CY},
+        {0, PI, CX, CY + R, CX, CY - R},
+        {PI / 2, PI, CX - R, CY, CX + R, CY},
+        {PI / 2, -PI, CX - R, CY, CX + R, CY},
+        {-PI / 2, PI, CX + R, CY, CX - R, CY},
+    };
+
+    for (const auto& c : cases) {
+        std::vector<drawing::Span> spans;
+        curve_algorithms::ArcAlgorithmExecutor::append_spans(CX, CY, R, c.start, c.sweep, 100, 100, spans);
+        const std::string name = "arc from " + std::to_string(c.start) + " by " + std::to_string(c.sweep);
+        check(contains(spans, c.start_row, c.start_column), name + " draws its start pixel");
+        check(contains(spans, c.end_row, c.end_column), name + " draws its end pixel");
+    }
+}
+
+// A looping cubic passes its self-intersection twice; that pixel, and every other, must be listed once
+void check_looping_bezier() {
+    const drawing::Point controls[] {{20, 20}, {180, 180}, {180, 20}, {20, 180}};
+    std::vector<drawing::Span> spans;
+    curve_algorithms::BezierAlgorithmExecutor::append_spans(controls, 200, 200, spans);
+
+    std::vector<uint8_t> seen(200 * 200, 0);
+    bool repeated = false;
+    for (const auto& span : spans) {
+        for (int32_t column = span.begin; column < span.end; ++column) {
+            repeated |= seen[span.row * 200 + column]++ != 0;
+        }
+    }
+    check(!repeated, "a looping cubic lists no pixel twice");
+    check(contains(spans, 20, 20), "a looping cubic draws its start pixel");
+}
+
+bool same_pixels(const bmp::ConstImageView& a, const bmp::ConstImageView& b) {
+    if (a.width != b.width || a.height != b.height || a.bit_count != b.bit_count) {
+        return false;
+    }
+    for (int32_t y = 0; y < a.height; ++y) {
+        if (std::memcmp(a.row(y), b.row(y), a.row_size_in_bytes()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compositing an image onto itself goes through a copy of its pixels; with a top-down file, whose
+// stored height is negative, the result must match compositing an independent copy of it
+void check_self_composite_top_down() {
+    const std::string path = (std::filesystem::temp_directory_path() / "lab4_checks_top_down.bmp").string();
+    {
+        bmp::BmpHandler image(9, 7, RGBA);
+        const bmp::ImageView pixels = image.view();
+        for (int32_t y = 0; y < pixels.height; ++y) {
+            for (size_t x = 0; x < pixels.row_size_in_bytes(); ++x) {
+                pixels.row(y)[x] = static_cast<uint8_t>(y * 37 + x * 11);
+            }
+        }
+        image.write(path);
+    }
+    {
+        // The height field of the info header follows the 14-byte file header and the 4-byte size
+        std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out};
+        int32_t height = 0;
+        file.seekg(22);
+        file.read(reinterpret_cast<char*>(&height), sizeof(height));
+        height = -height;
+        file.seekp(22);
+        file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+    }
+
+    bmp::BmpHandler self(path);
+    bmp::BmpHandler target(path);
+    const bmp::BmpHandler overlay(path);
+    check(self.get_image_height() < 0, "the patched file is read as top-down");
+    self.composite(self, 2, 1);
+    target.composite(overlay, 2, 1);
+    check(same_pixels(std::as_const(self).view(), std::as_const(target).view()),
+          "compositing a top-down image onto itself matches compositing a copy");
+    std::filesystem::remove(path);
+}
+
+// A luma shift of zero must leave every byte alone, however often it is applied
+void check_change_luma_zero() {
+    bmp::BmpHandler image(256, 256, RGB);
+    const bmp::ImageView pixels = image.view();
+    for (int32_t y = 0; y < pixels.height; ++y) {
+        for (int32_t x = 0; x < pixels.width; ++x) {
+            pixels.row(y)[x * 3] = static_cast<uint8_t>(x);
+            pixels.row(y)[x * 3 + 1] = static_cast<uint8_t>(y);
+            pixels.row(y)[x * 3 + 2] = static_cast<uint8_t>(x * 7 + y * 13);
+        }
+    }
+    const std::vector<uint8_t> before(pixels.data, pixels.data + pixels.stride * pixels.height);
+    const bmp::ConstImageView expected {before.data(), pixels.width, pixels.height, pixels.stride, pixels.bit_count};
+
+    for (int i = 0; i < 3; ++i) {
+        image.change_luma(0);
+    }
+    check(same_pixels(std::as_const(image).view(), expected), "change_luma(0) leaves the image unchanged");
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file {path, std::ios::binary};
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Flips the stored height of a written file, turning a bottom-up file into a top-down one
+void make_top_down(const std::string& path) {
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out};
+    int32_t height = 0;
+    file.seekg(22);
+    file.read(reinterpret_cast<char*>(&height), sizeof(height));
+    height = -height;
+    file.seekp(22);
+    file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+}
+
+// Saving a drawn-on canvas back to its own file rewrites only the dirty rows; the file must come
+// out the same as a full write. The long run spans several staging chunks of a bottom-up file.
+void check_in_place_save() {
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string path = (directory / "lab4_checks_in_place.bmp").string();
+    const std::string full_path = (directory / "lab4_checks_full.bmp").string();
+
+    for (const bool top_down : {false, true}) {
+        {
+            bmp::BmpHandler image(301, 2500, RGB, 0xFFFFFF);
+            image.write(path);
+        }
+        if (top_down) {
+            make_top_down(path);
+        }
+
+        drawing::BmpDrawer drawer(path);
+        std::vector<drawing::Span> spans {{0, 5, 40}, {7, 0, 301}, {2499, 290, 301}};
+        for (int32_t row = 100; row < 2400; ++row) {
+            spans.push_back({row, row % 301, std::min(row % 301 + 17, 301)});
+        }
+        drawer.draw(spans);
+        drawer.save(path);
+        drawer.save(full_path);
+
+        const std::string name = top_down ? "top-down" : "bottom-up";
+        check((drawer.get_handler().get_image_height() < 0) == top_down, name + " file keeps its row order");
+        check(read_file(path) == read_file(full_path), name + " in-place save matches a full write");
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(full_path);
+}
+
+int main() {
+    check_arc_ends();
+    check_looping_bezier();
+    check_self_composite_top_down();
+    check_change_luma_zero();
+    check_in_place_save();
+
+    if (failures == 0) {
+        std::cout << "all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
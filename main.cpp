@@ -61,25 +61,25 @@ void lab5() {
     });
 
     actions.emplace_back([source] {
-        const bmp::BmpHandler handler(source);
+        bmp::BmpHandler handler(source);
         handler.change_brightness(-25);
         handler.write(expand_home_directory("~/me/labs/ikg/lab4/output_data/lab5_file_bright.bmp"));
     });
 
     actions.emplace_back([source] {
-        const bmp::BmpHandler handler(source);
+        bmp::BmpHandler handler(source);
         handler.negative_transform(32);
         handler.write(expand_home_directory("~/me/labs/ikg/lab4/output_data/lab5_file_negative.bmp"));
     });
 
     actions.emplace_back([source] {
-        const bmp::BmpHandler handler(source);
+        bmp::BmpHandler handler(source);
         handler.increase_contrast(0, 100);
         handler.write(expand_home_directory("~/me/labs/ikg/lab4/output_data/lab5_file_inc_contr.bmp"));
     });
 
     actions.emplace_back([source] {
-        const bmp::BmpHandler handler(source);
+        bmp::BmpHandler handler(source);
         handler.decrease_contrast(32, 128);
         handler.write(expand_home_directory("~/me/labs/ikg/lab4/output_data/lab5_file_dec_contr.bmp"));
     });
@@ -91,7 +91,7 @@ void lab5() {
     });
 
     actions.emplace_back([source] {
-        const bmp::BmpHandler handler(source);
+        bmp::BmpHandler handler(source);
         handler.gamma_correct(6);
         handler.write(expand_home_directory("~/me/labs/ikg/lab4/output_data/lab5_file_gamma.bmp"));
     });